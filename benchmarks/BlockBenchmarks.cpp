@@ -0,0 +1,94 @@
+#include "AFLMutationFunctions.hh"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace AFLMutationFunctions;
+using namespace AFLMutationFunctions::Details;
+
+//! Sizes of the blocks that are moved or filled.
+static void BlockSizes( benchmark::internal::Benchmark* benchmark )
+{
+	benchmark->RangeMultiplier( 16 )->Range( 16, 16 << 20 );
+}
+
+//! Shifts a block left by one byte with std::ranges::copy.
+static void BM_ShiftLeftRanges( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) + 1 );
+	for( auto _ : state )
+	{
+		std::ranges::copy( vecBuffer.begin() + 1, vecBuffer.end(), vecBuffer.begin() );
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_ShiftLeftRanges )->Apply( BlockSizes );
+
+//! Shifts a block left by one byte with Details::MoveBytes.
+static void BM_ShiftLeftMoveBytes( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) + 1 );
+	for( auto _ : state )
+	{
+		MoveBytes( vecBuffer.data(), vecBuffer.data() + 1, state.range( 0 ) );
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_ShiftLeftMoveBytes )->Apply( BlockSizes );
+
+//! Shifts a block right by one byte with std::ranges::copy_backward.
+static void BM_ShiftRightRanges( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) + 1 );
+	for( auto _ : state )
+	{
+		std::ranges::copy_backward( vecBuffer.begin(), vecBuffer.end() - 1, vecBuffer.end() );
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_ShiftRightRanges )->Apply( BlockSizes );
+
+//! Shifts a block right by one byte with Details::MoveBytes.
+static void BM_ShiftRightMoveBytes( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) + 1 );
+	for( auto _ : state )
+	{
+		MoveBytes( vecBuffer.data() + 1, vecBuffer.data(), state.range( 0 ) );
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_ShiftRightMoveBytes )->Apply( BlockSizes );
+
+//! Fills a block with a repeated byte with std::ranges::fill.
+static void BM_FillRanges( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) );
+	byte value { 0 };
+	for( auto _ : state )
+	{
+		std::ranges::fill( vecBuffer, value );
+		value = static_cast< byte >( std::to_integer< int >( value ) + 1 );
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_FillRanges )->Apply( BlockSizes );
+
+//! Fills a block with a repeated byte with Details::FillBytes.
+static void BM_FillFillBytes( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) );
+	byte value { 0 };
+	for( auto _ : state )
+	{
+		FillBytes( vecBuffer, value );
+		value = static_cast< byte >( std::to_integer< int >( value ) + 1 );
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_FillFillBytes )->Apply( BlockSizes );
@@ -0,0 +1,127 @@
+# Compares the results of afl-mutation-bench against a recorded baseline.
+#
+# Usage: cmake -DRESULTS=<json> -DBASELINE=<json> -DBUILD_TYPE=<config> [-DTOLERANCE=<percent>] [-DUPDATE=ON]
+#        -P CompareBenchmarks.cmake
+#
+# The best items per second of the repetitions of every benchmark is compared with the baseline, since the best
+# repetition is far less noisy than the median on a shared machine. The script fails if any benchmark is slower
+# than the baseline by more than the tolerance. With UPDATE the results replace the baseline. Only Release builds
+# are compared, and the script also fails if the baseline is missing or was recorded with another number of CPUs.
+cmake_minimum_required(VERSION 3.19)
+
+if(NOT DEFINED RESULTS OR NOT DEFINED BASELINE)
+	message(FATAL_ERROR "RESULTS and BASELINE must be defined")
+endif()
+if(NOT DEFINED TOLERANCE)
+	set(TOLERANCE 35)
+endif()
+if(NOT BUILD_TYPE STREQUAL "Release")
+	message(FATAL_ERROR "Benchmarks of the '${BUILD_TYPE}' configuration are not comparable, use a Release build")
+endif()
+
+# Record a new baseline.
+if(UPDATE)
+	configure_file("${RESULTS}" "${BASELINE}" COPYONLY)
+	message(STATUS "Baseline ${BASELINE} updated")
+	return()
+endif()
+if(NOT EXISTS "${BASELINE}")
+	message(FATAL_ERROR "No baseline ${BASELINE}, build afl-mutation-bench-baseline to record one and check it in")
+endif()
+
+# Converts a JSON number to an integer by truncating its fraction, since math(EXPR) only supports integers.
+function(to_integer number output)
+	if(NOT number MATCHES "^([0-9]+)(\\.([0-9]*))?([eE]([+-]?[0-9]+))?$")
+		message(FATAL_ERROR "Unsupported throughput ${number}")
+	endif()
+	set(digits "${CMAKE_MATCH_1}${CMAKE_MATCH_3}")
+	string(LENGTH "${CMAKE_MATCH_3}" fraction)
+	set(exponent 0)
+	if(CMAKE_MATCH_5)
+		string(REGEX REPLACE "^\\+" "" exponent "${CMAKE_MATCH_5}")
+	endif()
+	math(EXPR shift "${exponent} - ${fraction}")
+	if(shift GREATER_EQUAL 0)
+		string(REPEAT "0" ${shift} zeros)
+		string(APPEND digits "${zeros}")
+	else()
+		string(LENGTH "${digits}" length)
+		math(EXPR length "${length} + ${shift}")
+		if(length LESS_EQUAL 0)
+			set(digits 0)
+		else()
+			string(SUBSTRING "${digits}" 0 ${length} digits)
+		endif()
+	endif()
+	string(REGEX REPLACE "^0+([0-9])" "\\1" digits "${digits}")
+	set(${output} ${digits} PARENT_SCOPE)
+endfunction()
+
+# Reads the number of CPUs of the machine that ran the benchmarks to <prefix>_CPUS.
+function(read_cpus file prefix)
+	file(READ "${file}" json)
+	string(JSON cpus GET "${json}" context num_cpus)
+	set(${prefix}_CPUS ${cpus} PARENT_SCOPE)
+endfunction()
+
+# Reads the best throughput of the repetitions of every benchmark to variables <prefix>_<hash of the name> and
+# their names to <prefix>_NAMES.
+function(read_best file prefix)
+	file(READ "${file}" json)
+	string(JSON count LENGTH "${json}" benchmarks)
+	set(names)
+	if(count GREATER 0)
+		math(EXPR last "${count} - 1")
+		foreach(i RANGE ${last})
+			string(JSON entry GET "${json}" benchmarks ${i})
+			string(JSON type ERROR_VARIABLE error GET "${entry}" run_type)
+			string(JSON throughput ERROR_VARIABLE error GET "${entry}" items_per_second)
+			if(type STREQUAL "iteration" AND NOT error)
+				string(JSON name GET "${entry}" run_name)
+				string(MD5 key "${name}")
+				to_integer(${throughput} throughput)
+				if(NOT DEFINED best_${key})
+					set(best_${key} ${throughput})
+					list(APPEND names "${name}")
+				elseif(throughput GREATER best_${key})
+					set(best_${key} ${throughput})
+				endif()
+				set(${prefix}_${key} ${best_${key}} PARENT_SCOPE)
+			endif()
+		endforeach()
+	endif()
+	set(${prefix}_NAMES "${names}" PARENT_SCOPE)
+endfunction()
+
+# Throughput depends on the machine, so the baseline must come from the same machine class.
+read_cpus("${BASELINE}" BASE)
+read_cpus("${RESULTS}" CURRENT)
+if(NOT BASE_CPUS EQUAL CURRENT_CPUS)
+	message(FATAL_ERROR "Baseline ${BASELINE} was recorded with ${BASE_CPUS} CPUs, not ${CURRENT_CPUS}, "
+		"set AFL_MUTATION_BENCH_MACHINE to the class of this machine")
+endif()
+
+read_best("${BASELINE}" BASE)
+read_best("${RESULTS}" CURRENT)
+
+# Compare every benchmark that has a baseline.
+set(regressions 0)
+foreach(name IN LISTS CURRENT_NAMES)
+	string(MD5 key "${name}")
+	if(NOT DEFINED BASE_${key})
+		message(STATUS "new       ${name}")
+		continue()
+	endif()
+	math(EXPR ratio "${CURRENT_${key}} * 1000 / (${BASE_${key}} + 1)" OUTPUT_FORMAT DECIMAL)
+	math(EXPR limit "1000 - ${TOLERANCE} * 10" OUTPUT_FORMAT DECIMAL)
+	if(ratio LESS limit)
+		message(STATUS "REGRESSED ${name}: ${ratio} permille of the baseline")
+		math(EXPR regressions "${regressions} + 1")
+	else()
+		message(STATUS "ok        ${name}: ${ratio} permille of the baseline")
+	endif()
+endforeach()
+
+if(regressions GREATER 0)
+	message(FATAL_ERROR "${regressions} benchmarks regressed by more than ${TOLERANCE}% of the baseline ${BASELINE}")
+endif()
@@ -0,0 +1,633 @@
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Async.hh"
+#include "AFLMutationFunctions/Corpus.hh"
+#include "AFLMutationFunctions/Deterministic.hh"
+#include "AFLMutationFunctions/Dictionary.hh"
+#include "AFLMutationFunctions/Effective.hh"
+#include "AFLMutationFunctions/Fields.hh"
+#include "AFLMutationFunctions/HotRegions.hh"
+#include "AFLMutationFunctions/PieceTable.hh"
+#include "AFLMutationFunctions/SharedTestcase.hh"
+#include "AFLMutationFunctions/Streaming.hh"
+#include "AFLMutationFunctions/Trace.hh"
+#include "AFLMutationFunctions/Undo.hh"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace AFLMutationFunctions;
+
+//! Creates a generator with a fixed seed.
+template< class Gen >
+static Gen MakeGenerator()
+{
+	return Gen { 42 };
+}
+
+//! Creates a bit pool over a base generator with a fixed seed.
+template<>
+RandomBitPool< Xoshiro256StarStar > MakeGenerator()
+{
+	return RandomBitPool { Xoshiro256StarStar { 42 } };
+}
+
+//! Buffer sizes and value sizes as percentages of the buffer size.
+static void BufferAndValueSizes( benchmark::internal::Benchmark* benchmark )
+{
+	benchmark->ArgNames( { "buffer", "value%" } )->ArgsProduct( { { 64, 4 << 10, 1 << 20 }, { 50, 100 } } );
+}
+
+//! Mutation buffer and value of a benchmark.
+template< class Gen >
+struct Fixture
+{
+	std::vector< byte > vecBuffer;  //!< Buffer containing the value.
+	size_t sizeValue;  //!< Size of the value.
+	Gen generator;  //!< Random number generator.
+
+	//! Creates the buffer from the benchmark arguments.
+	explicit Fixture( const benchmark::State& state ) :
+	vecBuffer( state.range( 0 ) ),
+	sizeValue { std::max< size_t >( 1, state.range( 0 ) * state.range( 1 ) / 100 ) },
+	generator { MakeGenerator< Gen >() }
+	{
+		for( size_t i = 0; i < vecBuffer.size(); i++ )
+			vecBuffer[ i ] = static_cast< byte >( i );
+	}
+
+	//! Gets the value.
+	std::span< byte > Value()
+	{
+		return std::span { vecBuffer }.subspan( 0, sizeValue );
+	}
+};
+
+//! Reports the throughput of a benchmark where every iteration applies one mutation to the value.
+static void ReportThroughput( benchmark::State& state, size_t sizeValue )
+{
+	state.SetItemsProcessed( state.iterations() );
+	state.SetBytesProcessed( state.iterations() * sizeValue );
+}
+
+template< class Gen >
+static void BM_FlipBit( benchmark::State& state )
+{
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		FlipBit( fixture.Value(), fixture.generator );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_InterestingValue( benchmark::State& state )
+{
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		InterestingValue( fixture.Value(), fixture.generator );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_Arithmetic( benchmark::State& state )
+{
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		Arithmetic( fixture.Value(), fixture.generator );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_ArithmeticSmallDelta( benchmark::State& state )
+{
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		ArithmeticSmallDelta( fixture.Value(), fixture.generator );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_RemoveRandomBlock( benchmark::State& state )
+{
+	// The value size is restored for every iteration. Its contents are not.
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		benchmark::DoNotOptimize( RemoveRandomBlock( fixture.Value(), fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_RandomBlockInsert( benchmark::State& state )
+{
+	// Inserting requires space after the value.
+	Fixture< Gen > fixture { state };
+	fixture.sizeValue = std::min( fixture.sizeValue, fixture.vecBuffer.size() - 1 );
+	for( auto _ : state )
+		benchmark::DoNotOptimize( RandomBlockInsert( std::span { fixture.vecBuffer }, fixture.sizeValue, fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_RandomChunkOverwrite( benchmark::State& state )
+{
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		RandomChunkOverwrite( fixture.Value(), fixture.generator );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_FillSubrangeWithRandomValues( benchmark::State& state )
+{
+	// Fill the second half of the value from the whole value.
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+	{
+		std::span< byte > spanValue = fixture.Value();
+		Details::FillSubrangeWithRandomValues( spanValue, spanValue.subspan( spanValue.size() / 2 ), fixture.generator );
+		benchmark::DoNotOptimize( spanValue.data() );
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_Havoc( benchmark::State& state )
+{
+	// Every round starts from a value of the same size.
+	Fixture< Gen > fixture { state };
+	HavocEngine< Gen > engine;
+	for( auto _ : state )
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Gen >
+static void BM_HavocStatic( benchmark::State& state )
+{
+	Fixture< Gen > fixture { state };
+	for( auto _ : state )
+		benchmark::DoNotOptimize( Havoc< DefaultOps< Gen > >( fixture.vecBuffer, fixture.sizeValue, fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+template< class Instrumentation >
+static void BM_HavocInstrumented( benchmark::State& state )
+{
+	Fixture< Xoshiro256StarStar > fixture { state };
+	HavocEngine< Xoshiro256StarStar, 5, UniformScheduler<>, Instrumentation > engine;
+	for( auto _ : state )
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+
+static void BM_HavocTraced( benchmark::State& state )
+{
+	// Record every round.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	TraceGenerator< Xoshiro256StarStar > tracer { fixture.generator };
+	HavocEngine< TraceGenerator< Xoshiro256StarStar > > engine;
+	for( auto _ : state )
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, tracer ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_HavocTraced )->Apply( BufferAndValueSizes );
+
+static void BM_ReplayHavoc( benchmark::State& state )
+{
+	// Replay recorded rounds in turn.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	TraceGenerator< Xoshiro256StarStar > tracer { fixture.generator };
+	HavocEngine< TraceGenerator< Xoshiro256StarStar > > engine;
+	std::vector< MutationTrace<> > vecTraces( 256 );
+	for( MutationTrace<>& trace : vecTraces )
+	{
+		engine( fixture.vecBuffer, fixture.sizeValue, tracer );
+		trace = tracer.GetTrace();
+	}
+	size_t sizeNext = 0;
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( ReplayHavoc( fixture.vecBuffer, fixture.sizeValue, vecTraces[ sizeNext ] ) );
+		sizeNext = ( sizeNext + 1 ) % vecTraces.size();
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_ReplayHavoc )->Apply( BufferAndValueSizes );
+
+//! Mutations that do not change the size of the value.
+template< class Gen >
+using ConstantOps = Ops< FlipBit< Gen >, InterestingValue< Gen >, Arithmetic< Gen >, RandomByteReplace< Gen > >;
+
+//! Creates an engine with either the default or only the constant mutations.
+template< class Gen, bool ConstantOnly >
+static HavocEngine< Gen > MakeRestoreEngine()
+{
+	if constexpr( ConstantOnly )
+		return HavocEngine< Gen > { ConstantOps< Gen >::template GetTable< Gen >() };
+	else
+		return HavocEngine< Gen > {};
+}
+
+template< bool ConstantOnly >
+static void BM_HavocRestoreByCopy( benchmark::State& state )
+{
+	// Copy the seed back after every round.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< byte > vecSeed = fixture.vecBuffer;
+	HavocEngine< Xoshiro256StarStar > engine = MakeRestoreEngine< Xoshiro256StarStar, ConstantOnly >();
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, fixture.generator ) );
+		std::ranges::copy( vecSeed, fixture.vecBuffer.begin() );
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocRestoreByCopy, false )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocRestoreByCopy, true )->Apply( BufferAndValueSizes );
+
+template< bool ConstantOnly >
+static void BM_HavocRestoreByRevert( benchmark::State& state )
+{
+	// Revert the journal after every round.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	using Journaler = UndoGenerator< Xoshiro256StarStar >;
+	Journaler journaler { fixture.generator, 32 * fixture.vecBuffer.size() };
+	HavocEngine< Journaler > engine = MakeRestoreEngine< Journaler, ConstantOnly >();
+	for( auto _ : state )
+	{
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, journaler ) );
+		journaler.Revert( fixture.vecBuffer );
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocRestoreByRevert, false )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocRestoreByRevert, true )->Apply( BufferAndValueSizes );
+
+//! Creates a dictionary of 256 tokens with sizes from 1 to 32 bytes.
+static TokenDictionary MakeDictionary()
+{
+	TokenDictionary dictionary;
+	std::array< byte, 32 > arrayToken {};
+	for( size_t i = 0; i < 256; i++ )
+	{
+		std::ranges::fill( arrayToken, static_cast< byte >( i ) );
+		dictionary.Add( std::span { arrayToken }.first( i % arrayToken.size() + 1 ) );
+	}
+	return dictionary;
+}
+
+static void BM_DictionaryOverwrite( benchmark::State& state )
+{
+	Fixture< Xoshiro256StarStar > fixture { state };
+	TokenDictionary dictionary = MakeDictionary();
+	DictionaryGenerator< Xoshiro256StarStar > generator { fixture.generator, dictionary };
+	for( auto _ : state )
+		DictionaryOverwrite( fixture.Value(), generator );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_DictionaryOverwrite )->Apply( BufferAndValueSizes );
+
+static void BM_DictionaryInsert( benchmark::State& state )
+{
+	// Inserting requires space after the value.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	fixture.sizeValue = std::min( fixture.sizeValue, fixture.vecBuffer.size() - 1 );
+	TokenDictionary dictionary = MakeDictionary();
+	DictionaryGenerator< Xoshiro256StarStar > generator { fixture.generator, dictionary };
+	for( auto _ : state )
+		benchmark::DoNotOptimize( DictionaryInsert( std::span { fixture.vecBuffer }, fixture.sizeValue, generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_DictionaryInsert )->Apply( BufferAndValueSizes );
+
+static void BM_Splice( benchmark::State& state )
+{
+	// Splice with 16 entries of the value size that share the first half of the value.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< std::vector< byte > > vecEntries( 16, std::vector< byte >( fixture.Value().begin(), fixture.Value().end() ) );
+	std::vector< std::span< const byte > > vecCorpus;
+	for( size_t i = 0; i < vecEntries.size(); i++ )
+	{
+		std::ranges::fill( std::span { vecEntries[ i ] }.subspan( fixture.sizeValue / 2 ), static_cast< byte >( i ) );
+		vecCorpus.push_back( vecEntries[ i ] );
+	}
+	SpliceGenerator< Xoshiro256StarStar > generator { fixture.generator, vecCorpus };
+	for( auto _ : state )
+		benchmark::DoNotOptimize( Splice( std::span { fixture.vecBuffer }, fixture.sizeValue, generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_Splice )->Apply( BufferAndValueSizes );
+
+//! Splits the buffer of a benchmark into 8 fields of equal capacity that are half full.
+static std::vector< FieldLayout > MakeFields( size_t sizeBuffer, std::vector< size_t >& vecSizes )
+{
+	std::vector< FieldLayout > vecFields;
+	for( size_t i = 0; i < 8; i++ )
+		vecFields.push_back( FieldLayout { i * ( sizeBuffer / 8 ), sizeBuffer / 8 } );
+	vecSizes.assign( vecFields.size(), sizeBuffer / 16 );
+	return vecFields;
+}
+
+static void BM_HavocFields( benchmark::State& state )
+{
+	// Mutate the fields in place.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< size_t > vecSizes;
+	std::vector< FieldLayout > vecFields = MakeFields( fixture.vecBuffer.size(), vecSizes );
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( auto _ : state )
+		benchmark::DoNotOptimize( HavocFields( engine, std::span { fixture.vecBuffer }, vecFields, vecSizes, fixture.generator ) );
+	ReportThroughput( state, fixture.vecBuffer.size() / 16 );
+}
+BENCHMARK( BM_HavocFields )->ArgNames( { "buffer", "value%" } )->Args( { 64, 100 } )->Args( { 4 << 10, 100 } )->Args( { 1 << 20, 100 } );
+
+static void BM_HavocSplitFields( benchmark::State& state )
+{
+	// Copy a field to its own buffer, mutate it and copy it back.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< size_t > vecSizes;
+	std::vector< FieldLayout > vecFields = MakeFields( fixture.vecBuffer.size(), vecSizes );
+	std::vector< byte > vecField( vecFields[ 0 ].sizeCapacity );
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( auto _ : state )
+	{
+		size_t index = Details::RandomInRange< size_t >( 0, vecFields.size() - 1, fixture.generator );
+		std::span< byte > spanField = std::span { fixture.vecBuffer }.subspan( vecFields[ index ].sizeOffset, vecFields[ index ].sizeCapacity );
+		std::ranges::copy( spanField, vecField.begin() );
+		vecSizes[ index ] = engine( vecField, vecSizes[ index ], fixture.generator ).size();
+		std::ranges::copy( vecField, spanField.begin() );
+	}
+	ReportThroughput( state, fixture.vecBuffer.size() / 16 );
+}
+BENCHMARK( BM_HavocSplitFields )->ArgNames( { "buffer", "value%" } )->Args( { 64, 100 } )->Args( { 4 << 10, 100 } )->Args( { 1 << 20, 100 } );
+
+template< bool Effective >
+static void BM_HavocUnchangedMutants( benchmark::State& state )
+{
+	// Count the rounds whose mutant equals its input, with and without redrawing ineffective steps.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	using Generator = std::conditional_t< Effective, EffectiveGenerator< Xoshiro256StarStar >, Xoshiro256StarStar >;
+	Generator generator { fixture.generator };
+	HavocEngine< Generator, 1 > engine;
+	std::vector< byte > vecInput = fixture.vecBuffer;
+	uint64_t ui64Unchanged = 0;
+	for( auto _ : state )
+	{
+		size_t sizeMutant = engine( fixture.vecBuffer, fixture.sizeValue, generator ).size();
+		ui64Unchanged += sizeMutant == fixture.sizeValue && std::ranges::equal( fixture.vecBuffer, vecInput );
+		std::ranges::copy( vecInput, fixture.vecBuffer.begin() );
+	}
+	state.counters[ "unchanged" ] = benchmark::Counter( static_cast< double >( ui64Unchanged ), benchmark::Counter::kAvgIterations );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocUnchangedMutants, false )->ArgNames( { "buffer", "value%" } )->Args( { 8, 25 } )->Args( { 64, 100 } );
+BENCHMARK_TEMPLATE( BM_HavocUnchangedMutants, true )->ArgNames( { "buffer", "value%" } )->Args( { 8, 25 } )->Args( { 64, 100 } );
+
+static void BM_DeterministicMutants( benchmark::State& state )
+{
+	// Produce the deterministic mutants one by one and restart the stages when they are exhausted.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::span< byte > spanValue = fixture.Value();
+	DeterministicMutator<> mutator;
+	for( auto _ : state )
+	{
+		if( ! mutator.Next( spanValue ) )
+		{
+			mutator = DeterministicMutator<> {};
+			mutator.Next( spanValue );
+		}
+		benchmark::DoNotOptimize( spanValue.data() );
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_DeterministicMutants )->ArgNames( { "buffer", "value%" } )->Args( { 64, 100 } )->Args( { 4 << 10, 100 } );
+
+//! Simulated execution time of the target in benchmarks that overlap mutation with execution.
+static constexpr std::chrono::microseconds TargetDuration { 5 };
+
+template< bool Overlap >
+static void BM_HavocWithTargetWait( benchmark::State& state )
+{
+	// Wait for a simulated target after every mutant, producing the next mutants during the wait if overlapped.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< byte > vecSeed( fixture.Value().begin(), fixture.Value().end() );
+	AsyncHavoc<> async { vecSeed, fixture.vecBuffer.size(), 4, fixture.generator };
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( auto _ : state )
+	{
+		if constexpr( Overlap )
+		{
+			benchmark::DoNotOptimize( async.Take().spanData.data() );
+			auto deadline = std::chrono::steady_clock::now() + TargetDuration;
+			async.Release();
+			while( std::chrono::steady_clock::now() < deadline )
+				async.Pump();
+		}
+		else
+		{
+			std::ranges::copy( vecSeed, fixture.vecBuffer.begin() );
+			benchmark::DoNotOptimize( engine( fixture.vecBuffer, vecSeed.size(), fixture.generator ).data() );
+			auto deadline = std::chrono::steady_clock::now() + TargetDuration;
+			while( std::chrono::steady_clock::now() < deadline )
+				;
+		}
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocWithTargetWait, false )->ArgNames( { "buffer", "value%" } )->Args( { 4 << 10, 50 } )->Args( { 64 << 10, 50 } );
+BENCHMARK_TEMPLATE( BM_HavocWithTargetWait, true )->ArgNames( { "buffer", "value%" } )->Args( { 4 << 10, 50 } )->Args( { 64 << 10, 50 } );
+
+template< class StackDepth >
+static void BM_HavocStackDepth( benchmark::State& state )
+{
+	// Every round starts from a value of the same size and draws its depth from the policy.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	HavocEngine< Xoshiro256StarStar, 5, UniformScheduler<>, NoInstrumentation, StackDepth > engine;
+	for( auto _ : state )
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocStackDepth, PowerOfTwoDepth<> )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocStackDepth, AFLStackDepth<> )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocStackDepth, AdaptiveDepth<> )->Apply( BufferAndValueSizes );
+
+//! Size of the packet buffers in the segmented benchmarks.
+static constexpr size_t PacketSize = 1500;
+
+//! Splits the value of a benchmark into segments of the size of a packet.
+static std::vector< std::span< byte > > MakePackets( std::span< byte > spanValue )
+{
+	std::vector< std::span< byte > > vecSegments;
+	for( size_t i = 0; i < spanValue.size(); i += PacketSize )
+		vecSegments.push_back( spanValue.subspan( i, std::min( PacketSize, spanValue.size() - i ) ) );
+	return vecSegments;
+}
+
+static void BM_SegmentedHavoc( benchmark::State& state )
+{
+	// Mutate the chain of packets without flattening it.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< std::span< byte > > vecSegments = MakePackets( fixture.Value() );
+	PieceTable table { fixture.vecBuffer.size(), vecSegments.size() + 256 };
+	for( auto _ : state )
+		benchmark::DoNotOptimize( SegmentedHavoc( table, vecSegments, fixture.vecBuffer.size(), fixture.generator ) );
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_SegmentedHavoc )->ArgNames( { "buffer", "value%" } )->Args( { 64 << 10, 50 } )->Args( { 1 << 20, 50 } );
+
+static void BM_FlattenedSegmentsHavoc( benchmark::State& state )
+{
+	// Copy the chain of packets to a staging buffer and mutate the copy.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< std::span< byte > > vecSegments = MakePackets( fixture.Value() );
+	std::vector< byte > vecStaging( fixture.vecBuffer.size() );
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( auto _ : state )
+	{
+		size_t sizeOffset = 0;
+		for( std::span< byte > spanSegment : vecSegments )
+		{
+			std::ranges::copy( spanSegment, vecStaging.begin() + sizeOffset );
+			sizeOffset += spanSegment.size();
+		}
+		benchmark::DoNotOptimize( engine( vecStaging, sizeOffset, fixture.generator ) );
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK( BM_FlattenedSegmentsHavoc )->ArgNames( { "buffer", "value%" } )->Args( { 64 << 10, 50 } )->Args( { 1 << 20, 50 } );
+
+template< class Clone >
+static void BM_CloneBlock( benchmark::State& state )
+{
+	// Clone blocks of one size between precomputed random, possibly overlapping, positions of a 64 KiB buffer.
+	std::vector< byte > vecBuffer( 64 << 10 );
+	size_t sizeBlock = state.range( 0 );
+	Xoshiro256StarStar generator = MakeGenerator< Xoshiro256StarStar >();
+	std::array< std::pair< size_t, size_t >, 1024 > arrayMoves {};
+	for( auto& [ sizeDestination, sizeSource ] : arrayMoves )
+	{
+		sizeSource = Details::RandomInRange< size_t >( 0, vecBuffer.size() - sizeBlock, generator );
+		size_t sizeLow = sizeSource - std::min( sizeSource, sizeBlock );
+		sizeDestination = Details::RandomInRange< size_t >( sizeLow, std::min( sizeSource + sizeBlock, vecBuffer.size() - sizeBlock ), generator );
+	}
+	size_t i = 0;
+	for( auto _ : state )
+	{
+		const auto& [ sizeDestination, sizeSource ] = arrayMoves[ i++ % arrayMoves.size() ];
+		Clone::Move( vecBuffer.data() + sizeDestination, vecBuffer.data() + sizeSource, sizeBlock );
+		benchmark::ClobberMemory();
+	}
+	ReportThroughput( state, sizeBlock );
+}
+//! Block sizes of the clone benchmarks.
+static void CloneBlockSizes( benchmark::internal::Benchmark* benchmark )
+{
+	benchmark->ArgName( "block" );
+	for( int64_t i64Size : { 1, 3, 8, 13, 16, 32, 64, 256, 1024, 4096 } )
+		benchmark->Arg( i64Size );
+}
+BENCHMARK_TEMPLATE( BM_CloneBlock, Details::DirectClone )->Apply( CloneBlockSizes );
+BENCHMARK_TEMPLATE( BM_CloneBlock, Details::ScratchClone<> )->Apply( CloneBlockSizes );
+BENCHMARK_TEMPLATE( BM_CloneBlock, Details::ScratchClone< 16 > )->Apply( CloneBlockSizes );
+
+template< bool Direct >
+static void BM_HavocToSharedTestcase( benchmark::State& state )
+{
+	// Hand a mutant of the seed to a shared test case region, either mutating in the region or copying to it.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	std::vector< byte > vecSeed( fixture.Value().begin(), fixture.Value().end() );
+	std::vector< uint32_t > vecRegion( ( SharedTestcase::HeaderSize + fixture.vecBuffer.size() + 3 ) / 4 );
+	SharedTestcase testcase { std::as_writable_bytes( std::span { vecRegion } ) };
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( auto _ : state )
+	{
+		if constexpr( Direct )
+		{
+			benchmark::DoNotOptimize( testcase.Havoc( engine, vecSeed, fixture.generator ) );
+		}
+		else
+		{
+			std::ranges::copy( vecSeed, fixture.vecBuffer.begin() );
+			benchmark::DoNotOptimize( testcase.Assign( engine( fixture.vecBuffer, vecSeed.size(), fixture.generator ) ) );
+		}
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocToSharedTestcase, false )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocToSharedTestcase, true )->Apply( BufferAndValueSizes );
+
+template< bool Hot >
+static void BM_HavocHotRegions( benchmark::State& state )
+{
+	// Apply havoc rounds with uniform offsets or offsets drawn from a map where one block in eight is hot.
+	Fixture< Xoshiro256StarStar > fixture { state };
+	HotRegionMap map { fixture.vecBuffer.size(), 6 };
+	for( size_t i = 0; i < map.Blocks(); i += 8 )
+		map.SetWeight( i, 100 );
+	using Gen = std::conditional_t< Hot, HotRegionGenerator< Xoshiro256StarStar >, Xoshiro256StarStar >;
+	Gen generator = [ & ] {
+		if constexpr( Hot )
+			return Gen { fixture.generator, map };
+		else
+			return fixture.generator;
+	}();
+	HavocEngine< Gen > engine;
+	for( auto _ : state )
+	{
+		std::ranges::fill( fixture.vecBuffer, byte { 0 } );
+		benchmark::DoNotOptimize( engine( fixture.vecBuffer, fixture.sizeValue, generator ) );
+	}
+	ReportThroughput( state, fixture.sizeValue );
+}
+BENCHMARK_TEMPLATE( BM_HavocHotRegions, false )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocHotRegions, true )->Apply( BufferAndValueSizes );
+
+template< bool Streaming >
+static void BM_HavocLargeValue( benchmark::State& state )
+{
+	// Mutate a large value either in windows streamed as segments or as a whole copy with room to grow.
+	std::vector< byte > vecValue( state.range( 0 ) );
+	for( size_t i = 0; i < vecValue.size(); i++ )
+		vecValue[ i ] = static_cast< byte >( i );
+	Xoshiro256StarStar generator = MakeGenerator< Xoshiro256StarStar >();
+	HavocEngine< Xoshiro256StarStar > engine;
+	StreamingHavoc streaming { 4096, 4096, 4 };
+	std::vector< byte > vecBuffer( Streaming ? 0 : vecValue.size() + 4096 );
+	for( auto _ : state )
+	{
+		if constexpr( Streaming )
+		{
+			benchmark::DoNotOptimize( streaming.Mutate( engine, vecValue, generator ) );
+		}
+		else
+		{
+			std::ranges::copy( vecValue, vecBuffer.begin() );
+			benchmark::DoNotOptimize( engine( vecBuffer, vecValue.size(), generator ) );
+		}
+	}
+	ReportThroughput( state, vecValue.size() );
+}
+BENCHMARK_TEMPLATE( BM_HavocLargeValue, false )->ArgName( "value" )->Arg( 1 << 20 )->Arg( 64 << 20 );
+BENCHMARK_TEMPLATE( BM_HavocLargeValue, true )->ArgName( "value" )->Arg( 1 << 20 )->Arg( 64 << 20 );
+
+//! Registers a benchmark for every generator type.
+#define AFL_MUTATION_BENCHMARK( function ) \
+	BENCHMARK_TEMPLATE( function, std::minstd_rand )->Apply( BufferAndValueSizes ); \
+	BENCHMARK_TEMPLATE( function, std::mt19937_64 )->Apply( BufferAndValueSizes ); \
+	BENCHMARK_TEMPLATE( function, Xoshiro256StarStar )->Apply( BufferAndValueSizes ); \
+	BENCHMARK_TEMPLATE( function, RandomBitPool< Xoshiro256StarStar > )->Apply( BufferAndValueSizes )
+
+AFL_MUTATION_BENCHMARK( BM_FlipBit );
+AFL_MUTATION_BENCHMARK( BM_InterestingValue );
+AFL_MUTATION_BENCHMARK( BM_Arithmetic );
+AFL_MUTATION_BENCHMARK( BM_ArithmeticSmallDelta );
+AFL_MUTATION_BENCHMARK( BM_RemoveRandomBlock );
+AFL_MUTATION_BENCHMARK( BM_RandomBlockInsert );
+AFL_MUTATION_BENCHMARK( BM_RandomChunkOverwrite );
+AFL_MUTATION_BENCHMARK( BM_FillSubrangeWithRandomValues );
+AFL_MUTATION_BENCHMARK( BM_Havoc );
+AFL_MUTATION_BENCHMARK( BM_HavocStatic );
+
+BENCHMARK_TEMPLATE( BM_HavocInstrumented, NoInstrumentation )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocInstrumented, CountingInstrumentation<> )->Apply( BufferAndValueSizes );
+BENCHMARK_TEMPLATE( BM_HavocInstrumented, CountingInstrumentation< true > )->Apply( BufferAndValueSizes );
@@ -0,0 +1,52 @@
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Parallel.hh"
+#include <benchmark/benchmark.h>
+#include <array>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace AFLMutationFunctions;
+
+//! Numbers of workers up to the number of hardware threads.
+static void WorkerCounts( benchmark::internal::Benchmark* benchmark )
+{
+	benchmark->ArgName( "workers" );
+	for( unsigned int ui = 1; ui <= std::max( 1u, std::thread::hardware_concurrency() ); ui *= 2 )
+		benchmark->Arg( ui );
+}
+
+//! Drains mutants of a corpus of 1 KB entries from a worker pool.
+static void BM_ParallelHavoc( benchmark::State& state )
+{
+	std::array< std::vector< byte >, 64 > arrayEntries {};
+	std::array< std::span< const byte >, 64 > arrayCorpus {};
+	for( size_t i = 0; i < arrayEntries.size(); i++ )
+	{
+		arrayEntries[ i ].assign( 1024, byte { static_cast< uint8_t >( i ) } );
+		arrayCorpus[ i ] = arrayEntries[ i ];
+	}
+
+	// Every iteration consumes a fixed number of mutants from all rings.
+	const size_t sizeMutants = 4096;
+	ParallelHavoc<> pool { arrayCorpus, 2048, static_cast< size_t >( state.range( 0 ) ), 1 };
+	for( auto _ : state )
+	{
+		size_t sizeConsumed = 0;
+		while( sizeConsumed < sizeMutants )
+		{
+			for( size_t i = 0; i < pool.GetWorkerCount(); i++ )
+			{
+				MutantRing& ring = pool.GetRing( i );
+				while( std::optional< RingMutant > mutant = ring.Peek() )
+				{
+					benchmark::DoNotOptimize( mutant->spanData.data() );
+					ring.Release();
+					sizeConsumed++;
+				}
+			}
+		}
+	}
+	state.SetItemsProcessed( state.iterations() * sizeMutants );
+}
+BENCHMARK( BM_ParallelHavoc )->Apply( WorkerCounts )->UseRealTime();
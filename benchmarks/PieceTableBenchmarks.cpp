@@ -0,0 +1,114 @@
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/PieceTable.hh"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace AFLMutationFunctions;
+
+//! Sizes of the mutated buffers.
+static void BufferSizes( benchmark::internal::Benchmark* benchmark )
+{
+	benchmark->RangeMultiplier( 16 )->Range( 4 << 10, 4 << 20 );
+}
+
+//! Applies havoc rounds to a contiguous value that fills half of the buffer.
+static void BM_HavocContiguous( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) );
+	Xoshiro256StarStar random;
+	HavocEngine< Xoshiro256StarStar > engine;
+	size_t sizeValue = vecBuffer.size() / 2;
+	for( auto _ : state )
+	{
+		sizeValue = engine( vecBuffer, sizeValue, random ).size();
+		if( sizeValue == 0 )
+			sizeValue = vecBuffer.size() / 2;
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_HavocContiguous )->Apply( BufferSizes );
+
+//! Applies havoc rounds to a value that fills half of the buffer through a piece table.
+static void BM_HavocPieceTable( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) );
+	Xoshiro256StarStar random;
+	PieceTable table { vecBuffer.size() };
+	size_t sizeValue = vecBuffer.size() / 2;
+	for( auto _ : state )
+	{
+		sizeValue = PieceTableHavoc( table, vecBuffer, sizeValue, random ).size();
+		if( sizeValue == 0 )
+			sizeValue = vecBuffer.size() / 2;
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetBytesProcessed( state.iterations() * state.range( 0 ) );
+}
+BENCHMARK( BM_HavocPieceTable )->Apply( BufferSizes );
+
+//! Number of small edits in one round of the edit benchmarks.
+static constexpr size_t SmallEdits = 32;
+
+//! Size of the blocks in the edit benchmarks.
+static constexpr size_t SmallBlock = 64;
+
+//! Inserts and removes small blocks at random positions of a contiguous value.
+static void BM_SmallEditsContiguous( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) + SmallBlock );
+	Xoshiro256StarStar random;
+	size_t sizeValue = state.range( 0 );
+	for( auto _ : state )
+	{
+		for( size_t i = 0; i < SmallEdits; i++ )
+		{
+			size_t sizeOffset = Details::RandomInRange< size_t >( 0, sizeValue - SmallBlock, random );
+			if( i % 2 == 0 )
+			{
+				Details::MoveBytes( vecBuffer.data() + sizeOffset + SmallBlock, vecBuffer.data() + sizeOffset, sizeValue - sizeOffset );
+				Details::FillBytes( std::span { vecBuffer }.subspan( sizeOffset, SmallBlock ), byte { 1 } );
+				sizeValue += SmallBlock;
+			}
+			else
+			{
+				Details::MoveBytes( vecBuffer.data() + sizeOffset, vecBuffer.data() + sizeOffset + SmallBlock, sizeValue - sizeOffset - SmallBlock );
+				sizeValue -= SmallBlock;
+			}
+		}
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * SmallEdits );
+}
+BENCHMARK( BM_SmallEditsContiguous )->Apply( BufferSizes );
+
+//! Inserts and removes small blocks at random positions through a piece table and flattens the result.
+static void BM_SmallEditsPieceTable( benchmark::State& state )
+{
+	std::vector< byte > vecBuffer( state.range( 0 ) + SmallBlock );
+	Xoshiro256StarStar random;
+	PieceTable table { SmallEdits * SmallBlock, SmallEdits * 2 + 1 };
+	size_t sizeValue = state.range( 0 );
+	for( auto _ : state )
+	{
+		table.Reset( vecBuffer, sizeValue );
+		for( size_t i = 0; i < SmallEdits; i++ )
+		{
+			size_t sizeOffset = Details::RandomInRange< size_t >( 0, table.Size() - SmallBlock, random );
+			if( i % 2 == 0 )
+			{
+				std::span< byte > spanBlock = table.Allocate( SmallBlock );
+				Details::FillBytes( spanBlock, byte { 1 } );
+				table.Insert( sizeOffset, spanBlock );
+			}
+			else
+			{
+				table.Erase( sizeOffset, SmallBlock );
+			}
+		}
+		sizeValue = table.Flatten().size();
+		benchmark::DoNotOptimize( vecBuffer.data() );
+	}
+	state.SetItemsProcessed( state.iterations() * SmallEdits );
+}
+BENCHMARK( BM_SmallEditsPieceTable )->Apply( BufferSizes );
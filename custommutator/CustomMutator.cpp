@@ -0,0 +1,157 @@
+/*! \file
+Custom mutator library of AFL++ that replaces its havoc stage with the havoc engine.
+
+Load it with AFL_CUSTOM_MUTATOR_LIBRARY. The output buffer of every mutator instance is allocated once in
+afl_custom_init, so the mutation callbacks do not allocate. Inputs and mutants are limited to the capacity of the
+buffer, which defaults to the 1 MiB maximum file size of AFL++ and can be changed with
+AFL_MUTATION_FUNCTIONS_MAX_SIZE.
+*/
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Batch.hh"
+
+//! Exports a callback of the library.
+#if defined( _WIN32 )
+#define AFL_MUTATION_FUNCTIONS_EXPORT __declspec( dllexport )
+#else
+#define AFL_MUTATION_FUNCTIONS_EXPORT __attribute__(( visibility( "default" ) ))
+#endif
+
+namespace
+{
+	using namespace AFLMutationFunctions;
+
+	//! Default capacity of the output buffer, the MAX_FILE of AFL++.
+	constexpr size_t DefaultCapacity = 1 << 20;
+
+	//! State of a mutator instance created by afl_custom_init.
+	struct CustomMutator
+	{
+		//! Generator seeded by AFL++.
+		Xoshiro256StarStar generator;
+
+		//! Engine of afl_custom_fuzz that stacks a round of mutations.
+		HavocEngine< Xoshiro256StarStar > engine;
+
+		//! Engine of afl_custom_havoc_mutation that applies a single mutation, which AFL++ stacks with its own.
+		HavocEngine< Xoshiro256StarStar, 5, UniformScheduler<>, NoInstrumentation, FixedDepth< 1 > > engineSingle;
+
+		//! Maximum size of a mutant.
+		size_t sizeCapacity;
+
+		//! Arena holding the single output mutant.
+		MutantArena arena;
+
+		//! Creates a mutator with an output buffer of a capacity.
+		CustomMutator(
+			uint64_t ui64Seed,  //!< Seed of the generator.
+			size_t sizeCapacity  //!< Maximum size of a mutant.
+		) :
+		generator { ui64Seed },
+		sizeCapacity { sizeCapacity },
+		arena { sizeCapacity, 1 }
+		{
+		}
+
+		//! Copies an input to the output buffer and mutates it there. Returns the size of the mutant.
+		template< class Engine >
+		size_t Mutate(
+			Engine& engineMutate,  //!< Engine that is applied to the input.
+			const unsigned char* pInput,  //!< Input that is mutated.
+			size_t sizeInput,  //!< Size of the input.
+			unsigned char** ppOutput,  //!< Receives the mutant.
+			size_t sizeMax  //!< Largest mutant accepted by AFL++.
+		)
+		{
+			// Mutate directly in the arena with the capacity limited by AFL++. The arena is padded past the capacity.
+			std::span< std::byte > spanArena = arena.GetArena();
+			MutantSlot slot {};
+			std::span< const std::byte > spanInput { reinterpret_cast< const std::byte* >( pInput ), sizeInput };
+			if( HavocBatch( engineMutate, spanInput, std::min( sizeMax, sizeCapacity ), spanArena, std::span { &slot, 1 }, generator ) == 0 )
+			{
+				*ppOutput = nullptr;
+				return 0;
+			}
+			*ppOutput = reinterpret_cast< unsigned char* >( spanArena.data() + slot.ui64Offset );
+			return slot.ui64Size;
+		}
+	};
+
+	//! Gets the capacity of the output buffer from the environment.
+	size_t GetCapacity()
+	{
+		const char* pValue = std::getenv( "AFL_MUTATION_FUNCTIONS_MAX_SIZE" );
+		size_t sizeCapacity = DefaultCapacity;
+		if( pValue != nullptr )
+			std::from_chars( pValue, pValue + std::strlen( pValue ), sizeCapacity );
+		return std::max< size_t >( sizeCapacity, 1 );
+	}
+}
+
+extern "C"
+{
+	//! Creates a mutator instance. Returns null if the instance or its output buffer cannot be allocated. The AFL++ state is not used.
+	AFL_MUTATION_FUNCTIONS_EXPORT void* afl_custom_init(
+		void*,  //!< State of AFL++.
+		unsigned int uiSeed  //!< Seed of the generator.
+	)
+	{
+		try
+		{
+			return new CustomMutator { uiSeed, GetCapacity() };
+		}
+		catch( const std::bad_alloc& )
+		{
+			return nullptr;
+		}
+	}
+
+	/*!
+	Mutates an input with a round of havoc mutations.
+
+	The splice buffer is not used because AFL++ splices in its own stage. The mutant stays valid until the next call.
+	*/
+	AFL_MUTATION_FUNCTIONS_EXPORT size_t afl_custom_fuzz(
+		void* pData,  //!< Mutator instance.
+		unsigned char* pBuffer,  //!< Input that is mutated.
+		size_t sizeBuffer,  //!< Size of the input.
+		unsigned char** ppOutput,  //!< Receives the mutant.
+		unsigned char*,  //!< Input to splice with.
+		size_t,  //!< Size of the input to splice with.
+		size_t sizeMax  //!< Largest mutant accepted by AFL++.
+	)
+	{
+		CustomMutator& mutator = *static_cast< CustomMutator* >( pData );
+		return mutator.Mutate( mutator.engine, pBuffer, sizeBuffer, ppOutput, sizeMax );
+	}
+
+	//! Applies a single havoc mutation that AFL++ stacks with its own mutations.
+	AFL_MUTATION_FUNCTIONS_EXPORT size_t afl_custom_havoc_mutation(
+		void* pData,  //!< Mutator instance.
+		unsigned char* pBuffer,  //!< Input that is mutated.
+		size_t sizeBuffer,  //!< Size of the input.
+		unsigned char** ppOutput,  //!< Receives the mutant.
+		size_t sizeMax  //!< Largest mutant accepted by AFL++.
+	)
+	{
+		CustomMutator& mutator = *static_cast< CustomMutator* >( pData );
+		return mutator.Mutate( mutator.engineSingle, pBuffer, sizeBuffer, ppOutput, sizeMax );
+	}
+
+	//! Destroys a mutator instance.
+	AFL_MUTATION_FUNCTIONS_EXPORT void afl_custom_deinit(
+		void* pData  //!< Mutator instance.
+	)
+	{
+		delete static_cast< CustomMutator* >( pData );
+	}
+}
@@ -8,14 +8,24 @@ No source code reused.
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <concepts>
 #include <cstdint>
+#include <limits>
 #include <random>
 #include <ranges>
 #include <span>
+#include <utility>
 
 #include "AFLMutationFunctions/Details.hh"
+#include "AFLMutationFunctions/Instrumentation.hh"
+#include "AFLMutationFunctions/Interesting.hh"
+#include "AFLMutationFunctions/Random.hh"
+#include "AFLMutationFunctions/Scheduler.hh"
+#include "AFLMutationFunctions/StackDepth.hh"
 
 namespace AFLMutationFunctions
 {
@@ -25,31 +35,27 @@ namespace AFLMutationFunctions
 	/*!
 	Replaces an integer of random length with an interesting value. Randomly chooses endian.
 
-	The input buffer must not be empty.
+	The interesting integers are taken from a table built with MakeInterestingTable. The input buffer must not be empty.
 	*/
-	template< class Gen >
+	template< class Gen, const auto& Table = DefaultInterestingTable >
 		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
 	void InterestingValue(
 		std::span< std::byte > spanBuffer,  //!< Buffer that is mutated.
 		Gen& generator  //!< Random number generator used as the source of randomness.
 	)
 	{
-		// Get the max byte size of the interesting value.
-		constexpr auto arrayInterestingInts { Details::GetInterestingArray() };
-		using InterestingIntegral = std::ranges::range_value_t< decltype( arrayInterestingInts ) >;
-		uint8_t ui8MaxSize = std::min( sizeof( InterestingIntegral ), spanBuffer.size_bytes() );
-		uint8_t ui8ValueSize = std::uniform_int_distribution< unsigned short >( 1, ui8MaxSize )( generator );
-		auto end = std::ranges::upper_bound( arrayInterestingInts, Details::MaxIntWithSize( ui8ValueSize ) );
-
-		// Get a random interesting integer that fits in the buffer.
-		std::ranges::subrange possible { arrayInterestingInts.begin(), end };
-		InterestingIntegral interesting = Details::Ranges::SelectRandom( possible, generator );
-
-		// Copy the interesting integer's bytes to a random location in the buffer.
-		std::span< const byte > spanInterestingBytes = std::as_bytes( std::span { std::addressof( interesting ), 1 } );
-		spanInterestingBytes = spanInterestingBytes.subspan( 0, ui8ValueSize );
-		std::span< byte > spanRandomSubspan = Details::SelectRandomSubspan( spanBuffer, ui8ValueSize, generator );
-		std::ranges::copy( spanInterestingBytes, spanRandomSubspan.begin() );
+		// Get the byte size of the interesting value.
+		size_t sizeMaxWidth = std::min( sizeof( uint64_t ), spanBuffer.size_bytes() );
+		size_t sizeWidth = Details::RandomInRange< size_t >( 1, sizeMaxWidth, generator );
+
+		// Get a random interesting integer that fits in the width.
+		size_t index = Details::RandomInRange< size_t >( 0, Table.arrayCountsByWidth[ sizeWidth ] - 1, generator );
+		uint64_t ui64Interesting = Table.arrayValues[ index ];
+
+		// Store the interesting integer to a random location in the buffer.
+		std::span< byte > spanRandomSubspan = Details::SelectRandomSubspan( spanBuffer, sizeWidth, generator );
+		Details::NotifyWrite( generator, spanBuffer, spanRandomSubspan.data() - spanBuffer.data(), sizeWidth );
+		Details::StoreInteger( spanRandomSubspan, ui64Interesting );
 	}
 
 	/*!
@@ -65,8 +71,9 @@ namespace AFLMutationFunctions
 	)
 	{
 		// Select a random byte and xor a random bit.
-		byte& byteSelected = Details::Ranges::SelectRandom( spanBuffer, generator );
-		byteSelected ^= byte { 1 } << std::uniform_int_distribution { 0, 7 }( generator );
+		byte& byteSelected = spanBuffer[ Details::RandomOffset( spanBuffer.size() - 1, generator ) ];
+		Details::NotifyWrite( generator, spanBuffer, &byteSelected - spanBuffer.data(), 1 );
+		byteSelected ^= byte { 1 } << Details::RandomInRange( 0u, 7u, generator );
 	}
 
 	/*!
@@ -82,21 +89,52 @@ namespace AFLMutationFunctions
 	)
 	{
 		// Generate a 64-bit random number.
-		uint64_t ui64Value = std::uniform_int_distribution< uint64_t > {}( generator );
+		uint64_t ui64Value = Details::RandomInRange( uint64_t { 0 }, std::numeric_limits< uint64_t >::max(), generator );
 
-		// Choose some bytes from the buffer into another 64-bit integer.
-		uint64_t ui64Temporary { 0 };
-		std::span< byte > spanTemporary = std::as_writable_bytes( std::span { &ui64Temporary, 1 } );
-		size_t size = std::uniform_int_distribution< size_t >(
-				1, std::min( sizeof( uint64_t ), spanBuffer.size() ) )( generator );
+		// Choose some bytes from the buffer.
+		size_t size = Details::RandomInRange< size_t >(
+				1, std::min( sizeof( uint64_t ), spanBuffer.size() ), generator );
 		std::span< byte > spanOut = Details::SelectRandomSubspan( spanBuffer, size, generator );
-		std::ranges::copy( spanOut, spanTemporary.begin() );
 
-		// Apply the arithmetic operation;
-		ui64Temporary = Operation {}( ui64Temporary, ui64Value );
+		// Apply the arithmetic operation to the bytes as an integer.
+		Details::NotifyWrite( generator, spanBuffer, spanOut.data() - spanBuffer.data(), size );
+		Details::ApplyToInteger( spanOut, [ = ]( auto value ) { return Operation {}( static_cast< uint64_t >( value ), ui64Value ); } );
+	}
 
-		// Copy the temporary value back to the buffer.
-		std::ranges::copy( spanTemporary.subspan( 0, size ), spanOut.begin() );
+	//! Largest delta added or subtracted by ArithmeticSmallDelta.
+	inline constexpr unsigned int ArithmeticMaxDelta = 35;
+
+	/*!
+	Adds or subtracts a small delta to an 8, 16, 32 or 64-bit integer in the buffer. Randomly chooses endian.
+
+	Like the arithmetic mutations of AFL, the delta is between 1 and ArithmeticMaxDelta. The input buffer must not be empty.
+	*/
+	template< class Gen, class Operation = std::plus< uint64_t > >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	void ArithmeticSmallDelta(
+		std::span< std::byte > spanBuffer,  //!< Buffer that is mutated.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Select a width that fits in the buffer.
+		unsigned int uiWidths = std::bit_width( std::min( sizeof( uint64_t ), spanBuffer.size() ) );
+		size_t sizeWidth = size_t { 1 } << Details::RandomInRange( 0u, uiWidths - 1, generator );
+		std::span< byte > spanOut = Details::SelectRandomSubspan( spanBuffer, sizeWidth, generator );
+
+		// Draw the delta and the endian together. Single bytes have no endian.
+		unsigned int uiDraw = Details::RandomInRange( 0u, sizeWidth == 1 ? ArithmeticMaxDelta - 1 : ArithmeticMaxDelta * 2 - 1, generator );
+		uint64_t ui64Delta = uiDraw % ArithmeticMaxDelta + 1;
+		bool bSwap = uiDraw >= ArithmeticMaxDelta;
+
+		// Apply the arithmetic operation in the selected endian.
+		Details::NotifyWrite( generator, spanBuffer, spanOut.data() - spanBuffer.data(), sizeWidth );
+		Details::ApplyToInteger( spanOut, [ = ]( auto value ) {
+			using T = decltype( value );
+			if( bSwap )
+				value = Details::SwapEndian( value );
+			value = static_cast< T >( Operation {}( static_cast< uint64_t >( value ), ui64Delta ) );
+			return bSwap ? Details::SwapEndian( value ) : value;
+		} );
 	}
 
 	/*!
@@ -112,9 +150,9 @@ namespace AFLMutationFunctions
 	)
 	{
 		// Set a random byte to a random location in the buffer.
-		byte& byteSelected = Details::Ranges::SelectRandom( spanBuffer, generator );
-		byteSelected = static_cast< byte >(
-				std::uniform_int_distribution< unsigned short > { 1, 255 }( generator ) );
+		byte& byteSelected = spanBuffer[ Details::RandomOffset( spanBuffer.size() - 1, generator ) ];
+		Details::NotifyWrite( generator, spanBuffer, &byteSelected - spanBuffer.data(), 1 );
+		byteSelected = static_cast< byte >( Details::RandomInRange( 1u, 255u, generator ) );
 	}
 
 	/*!
@@ -130,30 +168,33 @@ namespace AFLMutationFunctions
 	)
 	{
 		// Select random start end end positions in the buffer for a block to remove.
-		auto randomStart = spanBuffer.begin() + std::uniform_int_distribution< size_t >( 0, spanBuffer.size() - 1 )( generator );
-		auto randomEnd = randomStart + std::uniform_int_distribution< size_t >( 1, spanBuffer.end() - randomStart )( generator );
+		auto randomStart = spanBuffer.begin() + Details::RandomOffset( spanBuffer.size() - 1, generator );
+		auto randomEnd = randomStart + Details::RandomInRange< size_t >( 1, spanBuffer.end() - randomStart, generator );
 
 		// Move the data after the end of the block to the beginning of the block.
-		// Because data is copied left, randomStart cannot be in the range [randomEnd, spanBufer.end()).
-		// Therefore std::ranges::copy behavior is defined and can be usd.
 		assert( randomEnd > randomStart );
-		std::ranges::copy( randomEnd, spanBuffer.end(), randomStart );
+		size_t sizeStart = randomStart - spanBuffer.begin();
+		size_t sizeTail = spanBuffer.end() - randomEnd;
+		size_t sizeEnd = randomEnd - spanBuffer.begin();
+		Details::NotifyMove( generator, spanBuffer, sizeStart, sizeEnd, sizeTail );
+		Details::MoveBytes( spanBuffer.data() + sizeStart, spanBuffer.data() + sizeEnd, sizeTail );
 
-		// Set the tail bytes as zeros.
+		// Set the bytes vacated by the move as zeros.
 		// If the mutated field is not variable-sized, this ensures that the value is reduced.
-		auto tail = std::ranges::subrange( randomEnd, spanBuffer.end() );
-		std::ranges::fill( tail, byte { 0 } );
+		Details::NotifyWrite( generator, spanBuffer, sizeStart + sizeTail, spanBuffer.size() - sizeStart - sizeTail, true );
+		Details::FillBytes( spanBuffer.subspan( sizeStart + sizeTail ), byte { 0 } );
 
 		// Return a subspan of the reduced value.
-		return spanBuffer.subspan( 0, randomStart - spanBuffer.begin() + tail.size() );
+		return spanBuffer.subspan( 0, sizeStart + sizeTail );
 	}
 
 	/*!
 	Inserts a block to the buffer using either a cloned block or repeated random byte.
 
-	The buffer will be mutated from [Head | Tail] to [Head | Random Block | Tail].
+	The buffer will be mutated from [Head | Tail] to [Head | Random Block | Tail]. Cloned blocks are copied
+	with the clone policy.
 	*/
-	template< class Gen >
+	template< class Gen, Details::ClonePolicy Clone = Details::DirectClone >
 		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
 	std::span< byte > RandomBlockInsert(
 		std::span< byte > spanBuffer,  //!< Buffer containing the data that is mutated.
@@ -166,29 +207,31 @@ namespace AFLMutationFunctions
 
 		// Select a random position where the block will be inserted.
 		auto spanValue = std::ranges::subrange( spanBuffer.begin(), spanBuffer.begin() + sizeValue );
-		size_t sizeRandomBlock = std::uniform_int_distribution< size_t >( 1, spanBuffer.size() - sizeValue )( generator );
-		auto randomBegin = spanBuffer.begin() + std::uniform_int_distribution< size_t >( 0, sizeValue )( generator );
+		size_t sizeRandomBlock = Details::RandomInRange< size_t >( 1, spanBuffer.size() - sizeValue, generator );
+		auto randomBegin = spanBuffer.begin() + Details::RandomOffset( sizeValue, generator );
 		auto randomEnd = randomBegin + sizeRandomBlock;
 		auto randomBlock = std::ranges::subrange( randomBegin, randomEnd );
 
 		// Copy the tail end of the value to the end of the random block.
-		// Data is copied right, so copy_backward must be used.
 		auto valueEnd = spanBuffer.begin() + sizeValue;
-		auto tailEnd = randomEnd + std::ranges::distance( randomBegin, valueEnd );
+		[[maybe_unused]] auto tailEnd = randomEnd + std::ranges::distance( randomBegin, valueEnd );
 		assert( tailEnd <= spanBuffer.end() );
 		assert( randomBegin <= valueEnd );
 		assert( tailEnd > valueEnd );
-		std::ranges::copy_backward( randomBegin, valueEnd, tailEnd );
+		size_t sizeBegin = randomBegin - spanBuffer.begin();
+		Details::NotifyMove( generator, spanBuffer, sizeBegin + sizeRandomBlock, sizeBegin, sizeValue - sizeBegin );
+		Details::MoveBytes( spanBuffer.data() + sizeBegin + sizeRandomBlock, spanBuffer.data() + sizeBegin, sizeValue - sizeBegin );
 
 		// Fill the middle block with random data.
-		Details::FillSubrangeWithRandomValues( spanValue, randomBlock, generator );
+		Details::NotifyWrite( generator, spanBuffer, sizeBegin, sizeRandomBlock, true );
+		Details::FillSubrangeWithRandomValues< Clone >( spanValue, randomBlock, generator );
 
 		// Retrun the span of the new value.
 		return spanBuffer.subspan( 0, sizeValue + randomBlock.size() );
 	}
 
-	//! Overwrites a block in the buffer with either a cloned block or repeated random byte.
-	template< class Gen >
+	//! Overwrites a block in the buffer with either a cloned block copied with the clone policy or repeated random byte.
+	template< class Gen, Details::ClonePolicy Clone = Details::DirectClone >
 		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
 	void RandomChunkOverwrite(
 		std::span< byte > spanBuffer,  //!< Buffer containing the data that is mutated.
@@ -198,9 +241,10 @@ namespace AFLMutationFunctions
 		assert( spanBuffer.size() > 0 );
 
 		// Select a random subrange and fill it with random values.
-		size_t sizeRandomBlock = std::uniform_int_distribution< size_t >( 1, spanBuffer.size() )( generator );
+		size_t sizeRandomBlock = Details::RandomInRange< size_t >( 1, spanBuffer.size(), generator );
 		auto subrange = Details::Ranges::SelectRandomSubrange( spanBuffer, sizeRandomBlock, generator );
-		Details::FillSubrangeWithRandomValues( spanBuffer, subrange, generator );
+		Details::NotifyWrite( generator, spanBuffer, std::ranges::begin( subrange ) - spanBuffer.begin(), sizeRandomBlock );
+		Details::FillSubrangeWithRandomValues< Clone >( spanBuffer, subrange, generator );
 	}
 
 	// Gets mutation functions.
@@ -217,10 +261,275 @@ namespace AFLMutationFunctions
 						Mutation< Gen > { RandomByteReplace< Gen > },
 						Mutation< Gen > { RemoveRandomBlock< Gen > },
 						Mutation< Gen > { RandomBlockInsert< Gen > },
-						Mutation< Gen > { RandomByteReplace< Gen > },
+						Mutation< Gen > { RandomChunkOverwrite< Gen > },
 				} );
 	}
 
+	/*!
+	List of mutation functions that is known at compile-time.
+
+	Havoc< Ops< ... > > classifies the mutations at compile-time and dispatches them with a switch so that
+	each mutation can be inlined into the havoc loop.
+	*/
+	template< auto... fMutations >
+	struct Ops
+	{
+		//! Number of mutations in the list.
+		static constexpr size_t Size = sizeof...( fMutations );
+
+		//! Gets the mutations as a table that can be used with HavocEngine.
+		template< class Gen >
+		static constexpr auto GetTable()
+		{
+			using Details::MutationFunction;
+			using Details::StaticMutation;
+			return std::array< MutationFunction< Gen >, Size > { MutationFunction< Gen > { StaticMutation< fMutations > {} }... };
+		}
+
+		//! Invokes the mutation at an index.
+		template< class Gen >
+		static std::span< byte > Invoke(
+			size_t index,  //!< Index of the mutation in the list.
+			std::span< byte > spanBuffer,  //!< Buffer containing the value.
+			size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			return Invoke( index, spanBuffer, sizeValue, generator, std::make_index_sequence< Size > {} );
+		}
+
+	private:
+
+		//! Expands the list of mutations to a switch over the index.
+		template< class Gen, size_t... Indices >
+		static std::span< byte > Invoke(
+			size_t index,  //!< Index of the mutation in the list.
+			std::span< byte > spanBuffer,  //!< Buffer containing the value.
+			size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator,  //!< Random number generator used as the source of randomness.
+			std::index_sequence< Indices... >  //!< Indices of the mutations.
+		)
+		{
+			std::span< byte > spanValue = spanBuffer.subspan( 0, sizeValue );
+			( ( index == Indices &&
+					( spanValue = Details::InvokeMutation< fMutations, Gen >( spanBuffer, sizeValue, generator ), true ) ) ||
+					... );
+			return spanValue;
+		}
+	};
+
+	//! Concept for a specialization of Ops.
+	template< class T >
+	concept OpsList = requires { []< auto... fMutations >( Ops< fMutations... > ) {}( T {} ); };
+
+	namespace Details
+	{
+		//! Joins lists of mutations.
+		template< class... TOps >
+		struct JoinOps;
+
+		//! A single list is already joined.
+		template< auto... fMutations >
+		struct JoinOps< Ops< fMutations... > >
+		{
+			using Type = Ops< fMutations... >;
+		};
+
+		//! Joins the first two lists and the rest.
+		template< auto... fFirst, auto... fSecond, class... TRest >
+		struct JoinOps< Ops< fFirst... >, Ops< fSecond... >, TRest... >
+		{
+			using Type = typename JoinOps< Ops< fFirst..., fSecond... >, TRest... >::Type;
+		};
+	}
+
+	//! List of the mutations of several lists in order.
+	template< OpsList... TOps >
+	using JoinOps = typename Details::JoinOps< TOps... >::Type;
+
+	//! Mutations used by default.
+	template< class Gen >
+	using DefaultOps = Ops<
+			FlipBit< Gen >,
+			InterestingValue< Gen >,
+			Arithmetic< Gen, std::plus< uint64_t > >,
+			Arithmetic< Gen, std::minus< uint64_t > >,
+			RandomByteReplace< Gen >,
+			RemoveRandomBlock< Gen >,
+			RandomBlockInsert< Gen >,
+			RandomChunkOverwrite< Gen > >;
+
+	//! Gets a table of mutation functions that are dispatched without type erasure.
+	template< class Gen >
+	constexpr auto GetMutationTable()
+	{
+		return DefaultOps< Gen >::template GetTable< Gen >();
+	}
+
+	/*!
+	Reusable havoc mutator that owns its mutation table.
+
+	The table is built once when the engine is constructed. A round of mutations does not allocate memory.
+	The scheduler decides which suitable mutation is applied next. The instrumentation observes every round
+	and is free when it is NoInstrumentation. The stack depth policy draws the number of mutations of every
+	round and defaults to PowerOfTwoDepth< MaxIterationsPower >.
+	*/
+	template< class Gen, unsigned int MaxIterationsPower = 5, class Scheduler = UniformScheduler<>,
+		class Instrumentation = NoInstrumentation, class StackDepth = PowerOfTwoDepth< MaxIterationsPower > >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+			MutationScheduler< Scheduler, Gen > && MutationInstrumentation< Instrumentation > &&
+			StackDepthPolicy< StackDepth, Gen >
+	class HavocEngine
+	{
+	public:
+
+		//! Type of the mutations in the table.
+		using MutationFunction = Details::MutationFunction< Gen >;
+
+		//! Maximum number of mutations in the table.
+		static constexpr size_t MaxMutations = 32;
+
+	private:
+
+		//! Mutations that are available to the engine.
+		std::array< MutationFunction, MaxMutations > m_arrayMutations {};
+
+		//! Number of mutations in m_arrayMutations.
+		size_t m_sizeMutations = 0;
+
+		//! Scheduler that selects the mutations.
+		Scheduler m_scheduler;
+
+		//! Instrumentation that observes the rounds.
+		[[no_unique_address]] Instrumentation m_instrumentation;
+
+	public:
+
+		//! Creates an engine that uses the default mutations.
+		constexpr HavocEngine() :
+		HavocEngine( GetMutationTable< Gen >() )
+		{
+		}
+
+		//! Creates an engine that uses the specified mutations.
+		constexpr explicit HavocEngine(
+			std::span< const MutationFunction > spanMutations,  //!< Mutations that are copied to the engine.
+			Scheduler scheduler = Scheduler {},  //!< Scheduler that selects the mutations.
+			Instrumentation instrumentation = Instrumentation {}  //!< Instrumentation that observes the rounds.
+		) :
+		m_scheduler { std::move( scheduler ) },
+		m_instrumentation { std::move( instrumentation ) }
+		{
+			assert( spanMutations.size() <= MaxMutations );
+			m_sizeMutations = std::min( spanMutations.size(), MaxMutations );
+			std::ranges::copy( spanMutations.subspan( 0, m_sizeMutations ), m_arrayMutations.begin() );
+			m_scheduler.Initialize( GetMutations() );
+		}
+
+		//! Gets the mutations used by the engine.
+		constexpr std::span< const MutationFunction > GetMutations() const
+		{
+			return std::span { m_arrayMutations }.subspan( 0, m_sizeMutations );
+		}
+
+		//! Gets the scheduler that selects the mutations.
+		constexpr Scheduler& GetScheduler()
+		{
+			return m_scheduler;
+		}
+
+		//! Gets the scheduler that selects the mutations.
+		constexpr const Scheduler& GetScheduler() const
+		{
+			return m_scheduler;
+		}
+
+		//! Gets the instrumentation that observes the rounds.
+		constexpr Instrumentation& GetInstrumentation()
+		{
+			return m_instrumentation;
+		}
+
+		//! Gets the instrumentation that observes the rounds.
+		constexpr const Instrumentation& GetInstrumentation() const
+		{
+			return m_instrumentation;
+		}
+
+		//! Applies a number of havoc mutations in place.
+		std::span< std::byte > operator()(
+			std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+			size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			return Mutate( *this, spanBuffer, sizeValue, generator );
+		}
+
+		//! Applies a number of havoc mutations in place with a scheduler and an instrumentation that have no state to update.
+		std::span< std::byte > operator()(
+			std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+			size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+			requires MutationScheduler< const Scheduler, Gen > && MutationInstrumentation< const Instrumentation >
+		{
+			return Mutate( *this, spanBuffer, sizeValue, generator );
+		}
+
+	private:
+
+		//! Implements a round of havoc mutations for both const and non-const engines.
+		template< class Self >
+		static std::span< std::byte > Mutate(
+			Self& self,  //!< Engine that applies the mutations.
+			std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+			size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			// Nothing can be mutated in an empty buffer.
+			sizeValue = std::min( sizeValue, spanBuffer.size() );
+			std::span< byte > spanValue { spanBuffer.subspan( 0, sizeValue ) };
+			if( spanBuffer.empty() )
+				return spanValue;
+
+			// Mutate the field using a random number of mutations.
+			unsigned int uiHavocIterations = StackDepth::Draw( sizeValue, generator );
+			[[maybe_unused]] unsigned int uiRedraws = uiHavocIterations;
+			self.m_instrumentation.OnRound( uiHavocIterations );
+			if constexpr( Details::StepObserver< Gen > )
+				generator.BeginRound();
+
+			// Apply a round of mutations.
+			for( unsigned int i = 0; i < uiHavocIterations; i++ )
+			{
+				// Select a suitable mutation based on the buffer and value sizes.
+				Details::SizeState state = Details::GetSizeState( spanBuffer.size(), spanValue.size() );
+				self.m_instrumentation.OnSizeState( state );
+				if( ! self.m_scheduler.CanSelect( state ) )
+					break;
+				size_t index = self.m_scheduler.Select( state, generator );
+
+				// Apply the mutation and get the new value size.
+				size_t sizeBefore = spanValue.size();
+				uint64_t ui64Start = self.m_instrumentation.BeginMutation();
+				if constexpr( Details::StepObserver< Gen > )
+					generator.BeginStep( index );
+				spanValue = self.m_arrayMutations[ index ]( spanBuffer, sizeBefore, generator );
+				if constexpr( Details::StepObserver< Gen > )
+					generator.EndStep();
+				self.m_instrumentation.EndMutation( index, ui64Start, sizeBefore, spanValue.size() );
+
+				// Redraw ineffective steps at most as many times as there were planned iterations.
+				if constexpr( Details::EffectObserver< Gen > )
+					uiHavocIterations += Details::TakeRedraws( generator.IneffectiveSteps(), uiRedraws );
+			}
+
+			return spanValue;
+		}
+	};
+
 	//! Applies a number of havoc mutations in place.
 	template< unsigned int MaxIterationsPower = 5, class Gen >
 		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
@@ -230,27 +539,110 @@ namespace AFLMutationFunctions
 		Gen& generator  //!< Random number generator used as the source of randomness.
 	)
 	{
-		// Mutate the field using a random number of mutations.
+		// The engine and its mutation table are built at compile-time.
+		constexpr HavocEngine< Gen, MaxIterationsPower > engine {};
+		return engine( spanBuffer, sizeValue, generator );
+	}
+
+	//! Applies a number of havoc mutations in place with the number of mutations drawn by a stack depth policy.
+	template< class StackDepth, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > && StackDepthPolicy< StackDepth, Gen >
+	std::span< std::byte > Havoc(
+		std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// The engine and its mutation table are built at compile-time.
+		constexpr HavocEngine< Gen, 5, UniformScheduler<>, NoInstrumentation, StackDepth > engine {};
+		return engine( spanBuffer, sizeValue, generator );
+	}
+
+	//! Applies a number of havoc mutations in place to a buffer of a byte-like type such as char or uint8_t.
+	template< unsigned int MaxIterationsPower = 5, Details::ByteLike T, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	std::span< T > Havoc(
+		std::span< T > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		return Details::FromBytes< T >( Havoc< MaxIterationsPower >( std::as_writable_bytes( spanBuffer ), sizeValue, generator ) );
+	}
+
+	/*!
+	Applies a number of havoc mutations in place using mutations known at compile-time.
+
+	The mutations are classified at compile-time and invoked without indirect calls. The number of mutations
+	is drawn by a stack depth policy.
+	*/
+	template< OpsList TOps, class StackDepth, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > && StackDepthPolicy< StackDepth, Gen >
+	std::span< std::byte > Havoc(
+		std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Classify the mutations at compile-time.
+		static constexpr auto arrayTable = TOps::template GetTable< Gen >();
+		static constexpr Details::EligibleMutations< TOps::Size > eligible { arrayTable };
+
+		// Nothing can be mutated in an empty buffer.
 		sizeValue = std::min( sizeValue, spanBuffer.size() );
 		std::span< byte > spanValue { spanBuffer.subspan( 0, sizeValue ) };
-		unsigned int uiHavocIterations = std::pow( 2, std::uniform_real_distribution< double >(
-				0, MaxIterationsPower )( generator ) );
-
-		// Create a range of possible mutations.
-		auto arrayMutations = GetMutationFunctions< Gen >();
+		if( spanBuffer.empty() )
+			return spanValue;
 
 		// Apply a round of mutations.
-		for( int i = 0; i < uiHavocIterations; i++ )
+		unsigned int uiHavocIterations = StackDepth::Draw( sizeValue, generator );
+		[[maybe_unused]] unsigned int uiRedraws = uiHavocIterations;
+		if constexpr( Details::StepObserver< Gen > )
+			generator.BeginRound();
+		for( unsigned int i = 0; i < uiHavocIterations; i++ )
 		{
-			// Select s suitable mutation based on the and value sizes.
-			using Details::Mutation;
-			auto filtered = Details::Ranges::FilterMutations( arrayMutations, spanBuffer.size(), spanValue.size() );
-			Mutation< Gen > mutationSelected = Details::Ranges::SelectRandom( filtered, generator );
+			// Select a suitable mutation based on the buffer and value sizes.
+			Details::SizeState state = Details::GetSizeState( spanBuffer.size(), spanValue.size() );
+			if( eligible.Get( state ).empty() )
+				break;
+			size_t index = eligible.SelectRandom( state, generator );
 
 			// Apply the mutation and get the new value size.
-			spanValue = mutationSelected( spanBuffer, spanValue.size(), generator );
+			if constexpr( Details::StepObserver< Gen > )
+				generator.BeginStep( index );
+			spanValue = TOps::Invoke( index, spanBuffer, spanValue.size(), generator );
+			if constexpr( Details::StepObserver< Gen > )
+				generator.EndStep();
+
+			// Redraw ineffective steps at most as many times as there were planned iterations.
+			if constexpr( Details::EffectObserver< Gen > )
+				uiHavocIterations += Details::TakeRedraws( generator.IneffectiveSteps(), uiRedraws );
 		}
 
 		return spanValue;
 	}
+
+	//! Applies a number of havoc mutations in place using mutations known at compile-time.
+	template< OpsList TOps, unsigned int MaxIterationsPower = 5, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	std::span< std::byte > Havoc(
+		std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		return Havoc< TOps, PowerOfTwoDepth< MaxIterationsPower > >( spanBuffer, sizeValue, generator );
+	}
+
+	//! Applies a number of havoc mutations known at compile-time in place to a buffer of a byte-like type such as char or uint8_t.
+	template< OpsList TOps, unsigned int MaxIterationsPower = 5, Details::ByteLike T, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	std::span< T > Havoc(
+		std::span< T > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		return Details::FromBytes< T >( Havoc< TOps, MaxIterationsPower >( std::as_writable_bytes( spanBuffer ), sizeValue, generator ) );
+	}
 }
\ No newline at end of file
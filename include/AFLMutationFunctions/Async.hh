@@ -0,0 +1,319 @@
+/*! \file
+Coroutine producer of havoc mutants that overlaps mutation with the execution of the target.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Batch.hh"
+#include "AFLMutationFunctions/Parallel.hh"
+
+namespace AFLMutationFunctions
+{
+	namespace Details
+	{
+		/*!
+		Coroutine that produces a mutant every time it is resumed.
+
+		The coroutine starts suspended and suspends after every mutant. When a consumer awaits a mutant, the
+		producer transfers control back to it directly.
+		*/
+		class ProducerTask
+		{
+		public:
+
+			//! Promise of the producer coroutine.
+			struct promise_type
+			{
+				//! Consumer that is resumed when the next mutant is ready.
+				std::coroutine_handle<> continuation;
+
+				//! Creates the task that owns the coroutine.
+				ProducerTask get_return_object()
+				{
+					return ProducerTask { std::coroutine_handle< promise_type >::from_promise( *this ) };
+				}
+
+				//! Waits until the first mutant is requested.
+				std::suspend_always initial_suspend() noexcept
+				{
+					return {};
+				}
+
+				//! Keeps the frame alive until the task destroys it.
+				std::suspend_always final_suspend() noexcept
+				{
+					return {};
+				}
+
+				//! Producers do not return.
+				void return_void()
+				{
+				}
+
+				//! Mutations do not throw.
+				void unhandled_exception()
+				{
+					std::terminate();
+				}
+			};
+
+			//! Suspends the producer and resumes the waiting consumer if there is one.
+			struct Yield
+			{
+				//! Always suspends.
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				//! Transfers control to the waiting consumer or back to the caller of resume.
+				std::coroutine_handle<> await_suspend(
+					std::coroutine_handle< promise_type > producer  //!< Handle of the producer.
+				) noexcept
+				{
+					return std::exchange( producer.promise().continuation, std::noop_coroutine() );
+				}
+
+				//! Nothing is returned.
+				void await_resume() const noexcept
+				{
+				}
+			};
+
+		private:
+
+			//! Handle of the coroutine.
+			std::coroutine_handle< promise_type > m_handle;
+
+		public:
+
+			//! Takes the ownership of a coroutine.
+			explicit ProducerTask(
+				std::coroutine_handle< promise_type > handle  //!< Handle of the coroutine.
+			) :
+			m_handle { handle }
+			{
+				m_handle.promise().continuation = std::noop_coroutine();
+			}
+
+			ProducerTask( ProducerTask&& other ) noexcept :
+			m_handle { std::exchange( other.m_handle, {} ) }
+			{
+			}
+
+			ProducerTask( const ProducerTask& ) = delete;
+			ProducerTask& operator=( const ProducerTask& ) = delete;
+			ProducerTask& operator=( ProducerTask&& ) = delete;
+
+			//! Destroys the suspended coroutine.
+			~ProducerTask()
+			{
+				if( m_handle )
+					m_handle.destroy();
+			}
+
+			//! Gets the handle of the coroutine.
+			std::coroutine_handle< promise_type > Handle() const
+			{
+				return m_handle;
+			}
+		};
+	}
+
+	/*!
+	Single-threaded producer of havoc mutants of a seed into a bounded ring of slots.
+
+	The executor calls Pump or Fill while it waits for the target, so the next mutants are ready when the current
+	one finishes. A coroutine executor awaits Next instead, which produces a mutant only when none is ready.
+	The producer stops when every slot holds an unreleased mutant, so memory is bounded by the slots allocated
+	at construction. Mutants stay valid until they are released. The seed must outlive the mutants produced
+	from it.
+	*/
+	template< class Gen = Xoshiro256StarStar, class Engine = HavocEngine< Gen > >
+		requires std::uniform_random_bit_generator< Gen > && HavocMutator< Engine, Gen >
+	class AsyncHavoc
+	{
+	private:
+
+		//! Ring of the produced mutants.
+		MutantRing m_ring;
+
+		//! Generator used by the producer.
+		Gen m_generator;
+
+		//! Engine used by the producer.
+		Engine m_engine;
+
+		//! Seed that is mutated.
+		std::span< const std::byte > m_spanSeed;
+
+		//! Index of the corpus entry of the seed.
+		size_t m_sizeEntry = 0;
+
+		//! Coroutine that produces the mutants. Created last because it refers to the other members.
+		Details::ProducerTask m_producer;
+
+	public:
+
+		//! Awaitable that gets the oldest mutant and produces one first if none is ready.
+		class Awaiter
+		{
+		private:
+
+			//! Producer the mutant is taken from.
+			AsyncHavoc& m_async;
+
+		public:
+
+			//! Creates an awaiter of a producer.
+			explicit Awaiter(
+				AsyncHavoc& async  //!< Producer the mutant is taken from.
+			) :
+			m_async { async }
+			{
+			}
+
+			//! Does not suspend if a mutant is ready.
+			bool await_ready()
+			{
+				return m_async.m_ring.Peek().has_value();
+			}
+
+			//! Transfers control to the producer, which resumes the consumer after the next mutant.
+			std::coroutine_handle<> await_suspend(
+				std::coroutine_handle<> consumer  //!< Coroutine waiting for the mutant.
+			)
+			{
+				std::coroutine_handle< Details::ProducerTask::promise_type > producer = m_async.m_producer.Handle();
+				producer.promise().continuation = consumer;
+				return producer;
+			}
+
+			//! Gets the oldest mutant. It must be released after it was executed.
+			RingMutant await_resume()
+			{
+				std::optional< RingMutant > mutant = m_async.m_ring.Peek();
+				assert( mutant );
+				return *mutant;
+			}
+		};
+
+		//! Allocates the slots and creates a suspended producer.
+		AsyncHavoc(
+			std::span< const std::byte > spanSeed,  //!< Seed that is mutated.
+			size_t sizeCapacity,  //!< Maximum size of a single mutant.
+			size_t sizeSlots,  //!< Minimum number of mutants that are produced ahead. Rounded up to a power of two.
+			Gen generator,  //!< Generator used by the producer.
+			const Engine& engine = Engine {}  //!< Engine used by the producer.
+		) :
+		m_ring { sizeCapacity, std::max< size_t >( sizeSlots, 2 ) },
+		m_generator { std::move( generator ) },
+		m_engine { engine },
+		m_spanSeed { spanSeed },
+		m_producer { Produce() }
+		{
+		}
+
+		AsyncHavoc( const AsyncHavoc& ) = delete;
+		AsyncHavoc& operator=( const AsyncHavoc& ) = delete;
+
+		//! Gets the number of slots.
+		size_t Slots() const
+		{
+			return m_ring.Slots();
+		}
+
+		//! Replaces the seed. Mutants that were already produced from the previous seed are kept.
+		void SetSeed(
+			std::span< const std::byte > spanSeed,  //!< Seed that is mutated.
+			size_t sizeEntry = 0  //!< Index of the corpus entry of the seed reported with its mutants.
+		)
+		{
+			m_spanSeed = spanSeed;
+			m_sizeEntry = sizeEntry;
+		}
+
+		//! Produces a mutant if a slot is free. Returns false if every slot holds a mutant.
+		bool Pump()
+		{
+			if( m_ring.Reserve().empty() )
+				return false;
+			m_producer.Handle().resume();
+			return true;
+		}
+
+		//! Produces mutants until every slot holds a mutant. Returns the number of mutants produced.
+		size_t Fill()
+		{
+			size_t sizeProduced = 0;
+			while( Pump() )
+				sizeProduced++;
+			return sizeProduced;
+		}
+
+		//! Gets an awaitable of the oldest mutant.
+		Awaiter Next()
+		{
+			return Awaiter { *this };
+		}
+
+		//! Gets the oldest mutant and produces it first if none is ready.
+		RingMutant Take()
+		{
+			if( ! m_ring.Peek() )
+				Pump();
+			std::optional< RingMutant > mutant = m_ring.Peek();
+			assert( mutant );
+			return *mutant;
+		}
+
+		//! Releases the oldest mutant so that its slot can be reused.
+		void Release()
+		{
+			m_ring.Release();
+		}
+
+		//! Releases every produced mutant, for example after the seed was replaced.
+		void Discard()
+		{
+			while( m_ring.Peek() )
+				m_ring.Release();
+		}
+
+		//! Gets the generator used by the producer.
+		const Gen& GetGenerator() const
+		{
+			return m_generator;
+		}
+
+	private:
+
+		//! Produces a mutant every time the coroutine is resumed.
+		Details::ProducerTask Produce()
+		{
+			for( ;; )
+			{
+				// Mutate a copy of the seed directly in a free slot.
+				std::span< std::byte > spanSlot = m_ring.Reserve();
+				if( ! spanSlot.empty() )
+				{
+					size_t sizeSeed = std::min( m_spanSeed.size(), spanSlot.size() );
+					std::ranges::copy( m_spanSeed.subspan( 0, sizeSeed ), spanSlot.begin() );
+					std::span< std::byte > spanMutant = m_engine( spanSlot, sizeSeed, m_generator );
+					m_ring.Publish( spanMutant.size(), m_sizeEntry );
+				}
+				co_await Details::ProducerTask::Yield {};
+			}
+		}
+	};
+}
@@ -0,0 +1,193 @@
+/*! \file
+Batch havoc mutation into a contiguous, preallocated arena.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Alignment of the mutants in a batch arena.
+	inline constexpr size_t BatchAlignment = 64;
+
+	/*!
+	Location of a mutant in a batch arena.
+
+	The layout is fixed so that a table of slots can be shared with executors in other processes.
+	*/
+	struct MutantSlot
+	{
+		uint64_t ui64Offset = 0;  //!< Offset of the mutant from the beginning of the arena.
+		uint64_t ui64Size = 0;  //!< Size of the mutant.
+	};
+	static_assert( std::is_standard_layout_v< MutantSlot > && std::is_trivially_copyable_v< MutantSlot > );
+
+	//! Concept for a havoc mutator that can be used for batches.
+	template< class Engine, class Gen >
+	concept HavocMutator = std::invocable< Engine&, std::span< std::byte >, size_t, Gen& > &&
+			std::same_as< std::invoke_result_t< Engine&, std::span< std::byte >, size_t, Gen& >, std::span< std::byte > >;
+
+	//! Gets the distance between the beginnings of consecutive mutants in an arena.
+	constexpr size_t GetBatchStride(
+		size_t sizeCapacity  //!< Maximum size of a single mutant.
+	)
+	{
+		return ( sizeCapacity + BatchAlignment - 1 ) / BatchAlignment * BatchAlignment;
+	}
+
+	//! Gets the size of an arena that holds a number of mutants.
+	constexpr size_t GetBatchArenaSize(
+		size_t sizeCapacity,  //!< Maximum size of a single mutant.
+		size_t sizeCount  //!< Number of mutants.
+	)
+	{
+		return GetBatchStride( sizeCapacity ) * sizeCount;
+	}
+
+	/*!
+	Writes independent havoc mutants of a seed into an arena.
+
+	Mutant i is written to offset i * GetBatchStride( sizeCapacity ) with at most sizeCapacity bytes.
+	The number of mutants is limited by both the slot table and the arena size.
+	Returns the number of mutants written.
+	*/
+	template< class Engine, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+			HavocMutator< Engine, Gen >
+	size_t HavocBatch(
+		Engine& engine,  //!< Havoc mutator that is reused for every mutant.
+		std::span< const std::byte > spanSeed,  //!< Seed that is mutated.
+		size_t sizeCapacity,  //!< Maximum size of a single mutant.
+		std::span< std::byte > spanArena,  //!< Arena where the mutants are written.
+		std::span< MutantSlot > spanSlots,  //!< Table where the locations of the mutants are written.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Determine how many mutants fit.
+		size_t sizeStride = GetBatchStride( sizeCapacity );
+		if( sizeStride == 0 )
+			return 0;
+		size_t sizeCount = std::min( spanSlots.size(), spanArena.size() / sizeStride );
+
+		// Copy the seed directly to its final location and mutate it there.
+		size_t sizeSeed = std::min( spanSeed.size(), sizeCapacity );
+		for( size_t i = 0; i < sizeCount; i++ )
+		{
+			std::span< std::byte > spanBuffer = spanArena.subspan( i * sizeStride, sizeCapacity );
+			std::ranges::copy( spanSeed.subspan( 0, sizeSeed ), spanBuffer.begin() );
+			std::span< std::byte > spanMutant = engine( spanBuffer, sizeSeed, generator );
+			spanSlots[ i ] = MutantSlot { i * sizeStride, spanMutant.size() };
+		}
+
+		return sizeCount;
+	}
+
+	/*!
+	Owns an aligned arena and a slot table for a fixed number of mutants.
+
+	Memory is only allocated when the arena is constructed.
+	*/
+	class MutantArena
+	{
+	private:
+
+		//! Deletes memory allocated with BatchAlignment.
+		struct AlignedDelete
+		{
+			void operator()( std::byte* p ) const
+			{
+				::operator delete[]( p, std::align_val_t { BatchAlignment } );
+			}
+		};
+
+		//! Maximum size of a single mutant.
+		size_t m_sizeCapacity = 0;
+
+		//! Maximum number of mutants.
+		size_t m_sizeCount = 0;
+
+		//! Number of mutants currently in the arena.
+		size_t m_sizeFilled = 0;
+
+		//! Storage of the mutants.
+		std::unique_ptr< std::byte[], AlignedDelete > m_pArena;
+
+		//! Storage of the slot table.
+		std::unique_ptr< MutantSlot[] > m_pSlots;
+
+	public:
+
+		//! Allocates an arena.
+		MutantArena(
+			size_t sizeCapacity,  //!< Maximum size of a single mutant.
+			size_t sizeCount  //!< Maximum number of mutants.
+		) :
+		m_sizeCapacity { sizeCapacity },
+		m_sizeCount { sizeCount },
+		m_pArena { static_cast< std::byte* >( ::operator new[](
+				GetBatchArenaSize( sizeCapacity, sizeCount ), std::align_val_t { BatchAlignment } ) ) },
+		m_pSlots { std::make_unique< MutantSlot[] >( sizeCount ) }
+		{
+		}
+
+		//! Replaces the contents of the arena with mutants of a seed.
+		template< class Engine, class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+				HavocMutator< Engine, Gen >
+		size_t Fill(
+			Engine& engine,  //!< Havoc mutator that is reused for every mutant.
+			std::span< const std::byte > spanSeed,  //!< Seed that is mutated.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			m_sizeFilled = HavocBatch( engine, spanSeed, m_sizeCapacity, GetArena(), GetAllSlots(), generator );
+			return m_sizeFilled;
+		}
+
+		//! Gets the number of mutants in the arena.
+		size_t Size() const
+		{
+			return m_sizeFilled;
+		}
+
+		//! Gets a mutant.
+		std::span< const std::byte > operator[](
+			size_t index  //!< Index of the mutant.
+		) const
+		{
+			assert( index < m_sizeFilled );
+			const MutantSlot& slot = m_pSlots[ index ];
+			return std::span< const std::byte > { m_pArena.get() + slot.ui64Offset, slot.ui64Size };
+		}
+
+		//! Gets the whole arena. Mutant locations are described by GetSlots().
+		std::span< std::byte > GetArena() const
+		{
+			return { m_pArena.get(), GetBatchArenaSize( m_sizeCapacity, m_sizeCount ) };
+		}
+
+		//! Gets the locations of the mutants currently in the arena.
+		std::span< const MutantSlot > GetSlots() const
+		{
+			return { m_pSlots.get(), m_sizeFilled };
+		}
+
+	private:
+
+		//! Gets the whole slot table.
+		std::span< MutantSlot > GetAllSlots() const
+		{
+			return { m_pSlots.get(), m_sizeCount };
+		}
+	};
+}
@@ -0,0 +1,355 @@
+/*! \file
+Memory-mapped corpus and the splice mutation that combines a value with a corpus entry.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined( _WIN32 )
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Read-only mapping of a whole file.
+
+	The bytes are paged in by the operating system when they are read, so mapping a file does not load it
+	into memory. Empty files are represented by an empty view without a mapping.
+	*/
+	class MappedFile
+	{
+	private:
+
+		//! Mapped bytes of the file.
+		std::span< const byte > m_spanData;
+
+	public:
+
+		//! Maps a file. Returns nothing if the file cannot be opened or mapped.
+		static std::optional< MappedFile > Open(
+			const std::filesystem::path& path  //!< Path of the file.
+		)
+		{
+			MappedFile file;
+#if defined( _WIN32 )
+			// Map a view of the whole file and close the handles, which the view keeps alive.
+			HANDLE hFile = CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+			if( hFile == INVALID_HANDLE_VALUE )
+				return std::nullopt;
+			LARGE_INTEGER size {};
+			if( ! GetFileSizeEx( hFile, &size ) )
+			{
+				CloseHandle( hFile );
+				return std::nullopt;
+			}
+			if( size.QuadPart > 0 )
+			{
+				HANDLE hMapping = CreateFileMappingW( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+				void* pView = hMapping != nullptr ? MapViewOfFile( hMapping, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+				if( hMapping != nullptr )
+					CloseHandle( hMapping );
+				if( pView == nullptr )
+				{
+					CloseHandle( hFile );
+					return std::nullopt;
+				}
+				file.m_spanData = { static_cast< const byte* >( pView ), static_cast< size_t >( size.QuadPart ) };
+			}
+			CloseHandle( hFile );
+#else
+			// Map the whole file and close the descriptor, which the mapping keeps alive.
+			int iFile = open( path.c_str(), O_RDONLY | O_CLOEXEC );
+			if( iFile < 0 )
+				return std::nullopt;
+			struct stat status {};
+			if( fstat( iFile, &status ) != 0 || ! S_ISREG( status.st_mode ) )
+			{
+				close( iFile );
+				return std::nullopt;
+			}
+			if( status.st_size > 0 )
+			{
+				void* pView = mmap( nullptr, static_cast< size_t >( status.st_size ), PROT_READ, MAP_PRIVATE, iFile, 0 );
+				if( pView == MAP_FAILED )
+				{
+					close( iFile );
+					return std::nullopt;
+				}
+				file.m_spanData = { static_cast< const byte* >( pView ), static_cast< size_t >( status.st_size ) };
+			}
+			close( iFile );
+#endif
+			return file;
+		}
+
+		//! Moves a mapping.
+		MappedFile(
+			MappedFile&& other  //!< Mapping that is moved. It becomes empty.
+		) noexcept :
+		m_spanData { std::exchange( other.m_spanData, {} ) }
+		{
+		}
+
+		//! Moves a mapping.
+		MappedFile& operator=(
+			MappedFile&& other  //!< Mapping that is moved. It becomes empty.
+		) noexcept
+		{
+			if( this != &other )
+			{
+				Unmap();
+				m_spanData = std::exchange( other.m_spanData, {} );
+			}
+			return *this;
+		}
+
+		MappedFile( const MappedFile& ) = delete;
+		MappedFile& operator=( const MappedFile& ) = delete;
+
+		//! Unmaps the file.
+		~MappedFile()
+		{
+			Unmap();
+		}
+
+		//! Gets the bytes of the file.
+		std::span< const byte > Get() const
+		{
+			return m_spanData;
+		}
+
+	private:
+
+		//! Creates an empty mapping.
+		MappedFile() = default;
+
+		//! Releases the mapping.
+		void Unmap()
+		{
+			if( m_spanData.empty() )
+				return;
+#if defined( _WIN32 )
+			UnmapViewOfFile( m_spanData.data() );
+#else
+			munmap( const_cast< byte* >( m_spanData.data() ), m_spanData.size() );
+#endif
+			m_spanData = {};
+		}
+	};
+
+	/*!
+	Corpus whose entries are memory-mapped files.
+
+	Entries are exposed as views of the mappings, so no entry is ever copied to owned memory. The views stay
+	valid until the corpus is destroyed, but the list of entries moves when files are added.
+	*/
+	class MappedCorpus
+	{
+	private:
+
+		//! Mappings of the entries.
+		std::vector< MappedFile > m_vecFiles;
+
+		//! Views of the entries.
+		std::vector< std::span< const byte > > m_vecEntries;
+
+	public:
+
+		//! Maps a file and adds it to the corpus. Returns false if the file cannot be mapped.
+		bool Add(
+			const std::filesystem::path& path  //!< Path of the file.
+		)
+		{
+			std::optional< MappedFile > file = MappedFile::Open( path );
+			if( ! file )
+				return false;
+			m_vecEntries.push_back( file->Get() );
+			m_vecFiles.push_back( std::move( *file ) );
+			return true;
+		}
+
+		//! Maps every regular file in a directory. Returns the number of added files.
+		size_t AddDirectory(
+			const std::filesystem::path& path  //!< Path of the directory.
+		)
+		{
+			size_t sizeAdded = 0;
+			std::error_code error;
+			for( const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator { path, error } )
+			{
+				if( entry.is_regular_file( error ) && Add( entry.path() ) )
+					sizeAdded++;
+			}
+			return sizeAdded;
+		}
+
+		//! Gets the number of entries.
+		size_t Size() const
+		{
+			return m_vecEntries.size();
+		}
+
+		//! Gets the views of every entry.
+		std::span< const std::span< const byte > > GetEntries() const
+		{
+			return m_vecEntries;
+		}
+	};
+
+	namespace Details
+	{
+		//! Number of bytes compared at once when searching for differences.
+		inline constexpr size_t MismatchBlockSize = 64;
+
+		//! Gets the offset of the first byte where two spans of the same size differ, or their size if they are equal.
+		inline size_t FirstMismatch(
+			std::span< const byte > spanFirst,  //!< First span.
+			std::span< const byte > spanSecond  //!< Second span.
+		)
+		{
+			// Skip equal blocks with memcmp before comparing single bytes.
+			assert( spanFirst.size() == spanSecond.size() );
+			size_t sizeOffset = 0;
+			while( spanFirst.size() - sizeOffset >= MismatchBlockSize &&
+					std::memcmp( spanFirst.data() + sizeOffset, spanSecond.data() + sizeOffset, MismatchBlockSize ) == 0 )
+				sizeOffset += MismatchBlockSize;
+			while( sizeOffset < spanFirst.size() && spanFirst[ sizeOffset ] == spanSecond[ sizeOffset ] )
+				sizeOffset++;
+			return sizeOffset;
+		}
+
+		//! Gets the size of the longest common suffix of two spans of the same size.
+		inline size_t CommonSuffix(
+			std::span< const byte > spanFirst,  //!< First span.
+			std::span< const byte > spanSecond  //!< Second span.
+		)
+		{
+			// Skip equal blocks with memcmp before comparing single bytes.
+			assert( spanFirst.size() == spanSecond.size() );
+			size_t sizeSuffix = 0;
+			while( spanFirst.size() - sizeSuffix >= MismatchBlockSize &&
+					std::memcmp( spanFirst.data() + spanFirst.size() - sizeSuffix - MismatchBlockSize,
+							spanSecond.data() + spanSecond.size() - sizeSuffix - MismatchBlockSize, MismatchBlockSize ) == 0 )
+				sizeSuffix += MismatchBlockSize;
+			while( sizeSuffix < spanFirst.size() &&
+					spanFirst[ spanFirst.size() - sizeSuffix - 1 ] == spanSecond[ spanSecond.size() - sizeSuffix - 1 ] )
+				sizeSuffix++;
+			return sizeSuffix;
+		}
+
+		//! Concept for a random number generator that provides a corpus to the splice mutation.
+		template< class Gen >
+		concept CorpusSource = requires( const Gen& generator ) {
+			{
+				generator.GetCorpus()
+			} -> std::same_as< std::span< const std::span< const byte > > >;
+		};
+	}
+
+	/*!
+	Random bit generator adaptor that provides a corpus to the splice mutation.
+
+	The corpus is not owned, so every worker can share one corpus. The other hooks of the base generator are
+	forwarded, so it can be combined with the other adaptors.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< Gen >
+	class SpliceGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		//! Entries the values are spliced with.
+		std::span< const std::span< const byte > > m_spanCorpus;
+
+	public:
+
+		//! Creates a splice generator from a base generator.
+		SpliceGenerator(
+			Gen generator,  //!< Generator that provides the randomness.
+			std::span< const std::span< const byte > > spanCorpus  //!< Entries the values are spliced with. Must outlive the generator.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) },
+		m_spanCorpus { spanCorpus }
+		{
+		}
+
+		//! Gets the corpus.
+		std::span< const std::span< const byte > > GetCorpus() const
+		{
+			return m_spanCorpus;
+		}
+	};
+
+	/*!
+	Replaces the tail of the value with the tail of a random corpus entry.
+
+	Like the splicing stage of AFL, the split point is chosen between the first and the last byte where the value
+	and the entry differ. Only the bytes after the split point are read from the entry, and entries longer than
+	the buffer are truncated. The value is not modified if it equals the entry. The spliced value can be longer
+	or shorter, so the mutation is used as a ResizingMutation that is suitable in every size state.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+			Details::CorpusSource< std::remove_reference_t< Gen > >
+	std::span< byte > Splice(
+		std::span< byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Select a partner entry.
+		std::span< const std::span< const byte > > spanCorpus = generator.GetCorpus();
+		std::span< byte > spanValue = spanBuffer.subspan( 0, sizeValue );
+		if( spanCorpus.empty() )
+			return spanValue;
+		std::span< const byte > spanPartner = spanCorpus[ Details::RandomInRange< size_t >( 0, spanCorpus.size() - 1, generator ) ];
+		spanPartner = spanPartner.first( std::min( spanPartner.size(), spanBuffer.size() ) );
+
+		// Find where the value and the partner differ. Bytes past the end of the shorter one differ.
+		size_t sizeCommon = std::min( spanValue.size(), spanPartner.size() );
+		size_t sizeFirst = Details::FirstMismatch( spanValue.first( sizeCommon ), spanPartner.first( sizeCommon ) );
+		size_t sizeLast = sizeCommon;
+		if( spanValue.size() == spanPartner.size() )
+		{
+			if( sizeFirst == sizeCommon )
+				return spanValue;
+			sizeLast = sizeCommon - 1 - Details::CommonSuffix( spanValue.subspan( sizeFirst ), spanPartner.subspan( sizeFirst ) );
+		}
+
+		// Copy the tail of the partner after the split point and clear the rest of the old value.
+		size_t sizeSplit = Details::RandomInRange< size_t >( sizeFirst, sizeLast, generator );
+		size_t sizeWritten = std::max( spanValue.size(), spanPartner.size() ) - sizeSplit;
+		Details::NotifyWrite( generator, spanBuffer, sizeSplit, sizeWritten, spanValue.size() != spanPartner.size() );
+		std::ranges::copy( spanPartner.subspan( sizeSplit ), spanBuffer.begin() + sizeSplit );
+		if( spanPartner.size() < spanValue.size() )
+			Details::FillBytes( spanValue.subspan( spanPartner.size() ), byte { 0 } );
+
+		// Return the span of the new value.
+		return spanBuffer.subspan( 0, spanPartner.size() );
+	}
+
+	//! Default mutations followed by the splice mutation.
+	template< class Gen >
+	using SpliceOps = JoinOps< DefaultOps< Gen >, Ops< Details::ResizingMutation< Splice< Gen > > {} > >;
+}
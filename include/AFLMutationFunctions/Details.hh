@@ -5,13 +5,20 @@ Helpers for implementations of AFL mutation functions.
 #pragma once
 
 #include <array>
+#include <bit>
 #include <vector>
 #include <span>
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <functional>
 #include <concepts>
+#include <cstring>
+#include <limits>
+#include <utility>
 
 #include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Random.hh"
 
 namespace AFLMutationFunctions::Details
 {
@@ -142,6 +149,19 @@ namespace AFLMutationFunctions::Details
 		return array;
 	}
 
+	//! Concept for a mutable one-byte integer type other than std::byte, such as char or uint8_t.
+	template< class T >
+	concept ByteLike = std::integral< T > && sizeof( T ) == 1 && ! std::same_as< T, bool > && ! std::is_const_v< T >;
+
+	//! Reinterprets a span of bytes as a span of a byte-like type.
+	template< ByteLike T >
+	std::span< T > FromBytes(
+		std::span< byte > spanBytes  //!< Bytes that are reinterpreted.
+	)
+	{
+		return { reinterpret_cast< T* >( spanBytes.data() ), spanBytes.size() };
+	}
+
 	//! Concept for a size-reducing mutation function.
 	template< class F, class TByte, class Gen >
 	concept Reducing = std::invocable< F, std::span< TByte >, Gen& > &&
@@ -157,6 +177,49 @@ namespace AFLMutationFunctions::Details
 	concept Constant = std::invocable< F, std::span< TByte >, Gen& > &&
 			std::same_as< std::invoke_result_t< F, std::span< TByte >, Gen& >, void >;
 
+	/*!
+	Marks a mutation with the signature of increasing mutations that can both grow and shrink the value.
+
+	The value never outgrows the buffer, so resizing mutations are suitable for empty values and for values that
+	fill the whole buffer. Use ResizingMutation< fMutation > {} in place of the mutation in Ops.
+	*/
+	template< auto fMutation >
+	struct ResizingMutation
+	{
+		//! Invokes the mutation.
+		template< class TByte, class Gen >
+			requires Increasing< decltype( fMutation ), TByte, Gen >
+		constexpr std::span< TByte > operator()(
+			std::span< TByte > buffer,  //!< Buffer containing the value.
+			size_t size,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+		{
+			return fMutation( buffer, size, generator );
+		}
+	};
+
+	//! Whether a type is a ResizingMutation.
+	template< class F >
+	inline constexpr bool IsResizingMutation = false;
+
+	//! A ResizingMutation is a resizing mutation.
+	template< auto fMutation >
+	inline constexpr bool IsResizingMutation< ResizingMutation< fMutation > > = true;
+
+	//! Concept for a mutation function that can both grow and shrink the value within the buffer.
+	template< class F, class TByte, class Gen >
+	concept Resizing = Increasing< F, TByte, Gen > && IsResizingMutation< std::remove_cvref_t< F > >;
+
+	//! Types of mutation functions.
+	enum class MutationType
+	{
+		Constant = 0,
+		Reducing,
+		Increasing,
+		Resizing
+	};
+
 	//! Class for treating mutation functions polymorphically.
 	template< class Gen, class TByte = byte >
 		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
@@ -164,14 +227,6 @@ namespace AFLMutationFunctions::Details
 	{
 	private:
 
-		//! Types of mutation functions.
-		enum class MutationType
-		{
-			Constant = 0,
-			Reducing,
-			Increasing
-		};
-
 		//! Function object that implements the mutation.
 		std::function< std::span< TByte >( std::span< TByte >, size_t, Gen& ) > m_fMutation;
 
@@ -203,6 +258,15 @@ namespace AFLMutationFunctions::Details
 		{
 		}
 
+		//! Constructor for a mutation that can both grow and shrink the value.
+		explicit Mutation(
+			Resizing< TByte, Gen > auto&& resizingMutation  //!< Mutation implementation.
+		) :
+		m_fMutation { resizingMutation },
+		m_mutationtype { MutationType::Resizing }
+		{
+		}
+
 		//! Constructor for a size-reducing mutation.
 		explicit Mutation(
 			Reducing< TByte, Gen > auto&& reducingMutation  //!< Mutation implementation.
@@ -235,6 +299,12 @@ namespace AFLMutationFunctions::Details
 			return m_mutationtype == MutationType::Constant;
 		}
 
+		//! Returns true if the mutation can both grow and shrink the mutated value within the buffer.
+		bool IsResizing() const
+		{
+			return m_mutationtype == MutationType::Resizing;
+		}
+
 		//! Invokes the mutation.
 		std::span< TByte > operator()(
 			std::span< TByte > buffer,  //! Buffer containing the value.
@@ -246,6 +316,166 @@ namespace AFLMutationFunctions::Details
 		}
 	};
 
+	//! Carries a mutation function as a compile-time constant so it can be dispatched without type erasure.
+	template< auto fMutation >
+	struct StaticMutation
+	{
+		//! The mutation function.
+		static constexpr auto function = fMutation;
+	};
+
+	//! Concept for a function that implements any type of mutation.
+	template< class F, class TByte, class Gen >
+	concept AnyMutation = Constant< F, TByte, Gen > || Reducing< F, TByte, Gen > || Increasing< F, TByte, Gen >;
+
+	//! Classifies a mutation function.
+	template< class F, class Gen, class TByte = byte >
+		requires AnyMutation< F, TByte, Gen >
+	constexpr MutationType GetMutationType()
+	{
+		if constexpr( Resizing< F, TByte, Gen > )
+			return MutationType::Resizing;
+		else if constexpr( Increasing< F, TByte, Gen > )
+			return MutationType::Increasing;
+		else if constexpr( Reducing< F, TByte, Gen > )
+			return MutationType::Reducing;
+		else
+			return MutationType::Constant;
+	}
+
+	//! Invokes a mutation function that is known at compile-time with the signature shared by all mutation types.
+	template< auto fMutation, class Gen, class TByte = byte >
+		requires AnyMutation< decltype( fMutation ), TByte, Gen >
+	std::span< TByte > InvokeMutation(
+		std::span< TByte > buffer,  //! Buffer containing the value.
+		size_t size,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Pass the value or the whole buffer depending on the type of the mutation.
+		using F = decltype( fMutation );
+		if constexpr( Increasing< F, TByte, Gen > )
+		{
+			return fMutation( buffer, size, generator );
+		}
+		else if constexpr( Reducing< F, TByte, Gen > )
+		{
+			return fMutation( buffer.subspan( 0, size ), generator );
+		}
+		else
+		{
+			std::span< TByte > value = buffer.subspan( 0, size );
+			fMutation( value, generator );
+			return value;
+		}
+	}
+
+	/*!
+	Mutation function that is dispatched through a plain function pointer.
+
+	Unlike Mutation, this class never allocates and can be stored in constexpr tables.
+	The mutation is bound at compile-time with StaticMutation.
+	*/
+	template< class Gen, class TByte = byte >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	class MutationFunction
+	{
+	private:
+
+		//! Signature shared by all mutation types.
+		using Signature = std::span< TByte >( std::span< TByte >, size_t, Gen& );
+
+		//! Function that implements the mutation.
+		Signature* m_pfMutation = nullptr;
+
+		//! Type of this mutation.
+		MutationType m_mutationtype = MutationType::Constant;
+
+	public:
+
+		//! Creates an empty mutation function that must not be invoked.
+		constexpr MutationFunction() = default;
+
+		//! Binds a mutation function.
+		template< auto fMutation >
+			requires AnyMutation< decltype( fMutation ), TByte, Gen >
+		constexpr explicit MutationFunction(
+			StaticMutation< fMutation >  //!< Mutation implementation.
+		) :
+		m_pfMutation { &InvokeMutation< fMutation, Gen, TByte > },
+		m_mutationtype { GetMutationType< decltype( fMutation ), Gen, TByte >() }
+		{
+		}
+
+		//! Returns true if the mutation will reduce the size of the mutated value.
+		constexpr bool IsReducing() const
+		{
+			return m_mutationtype == MutationType::Reducing;
+		}
+
+		//! Returns true if the mutation will increase the size of the mutated value.
+		constexpr bool IsIncreasing() const
+		{
+			return m_mutationtype == MutationType::Increasing;
+		}
+
+		//! Returns true if the mutation won't change the size of the mutated value.
+		constexpr bool IsConstant() const
+		{
+			return m_mutationtype == MutationType::Constant;
+		}
+
+		//! Returns true if the mutation can both grow and shrink the mutated value within the buffer.
+		constexpr bool IsResizing() const
+		{
+			return m_mutationtype == MutationType::Resizing;
+		}
+
+		//! Invokes the mutation.
+		std::span< TByte > operator()(
+			std::span< TByte > buffer,  //! Buffer containing the value.
+			size_t size,  //!< Bounds of the value currently contained in buffer.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+		{
+			assert( m_pfMutation != nullptr );
+			return m_pfMutation( buffer, size, generator );
+		}
+	};
+
+	/*!
+	Concept for a generator that draws the positions of the mutations itself.
+
+	DrawOffset gets an offset in range [0, sizeMax]. Offsets are relative to the beginning of the span passed
+	to the mutation.
+	*/
+	template< class Gen >
+	concept OffsetSource = requires( Gen& generator, size_t sizeMax ) {
+		{
+			generator.DrawOffset( sizeMax )
+		} -> std::convertible_to< size_t >;
+	};
+
+	//! Draws the offset of a position in range [0, sizeMax]. Generators that draw offsets themselves are used directly.
+	template< class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	constexpr size_t RandomOffset(
+		size_t sizeMax,  //!< Largest possible offset.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		if constexpr( OffsetSource< Gen > )
+		{
+			size_t sizeOffset = generator.DrawOffset( sizeMax );
+			assert( sizeOffset <= sizeMax );
+			return sizeOffset;
+		}
+		else
+		{
+			return RandomInRange< size_t >( 0, sizeMax, generator );
+		}
+	}
+
 	//! Selects a random subspan of a specified size.
 	template< class Gen, typename T >
 		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
@@ -259,7 +489,7 @@ namespace AFLMutationFunctions::Details
 		assert( size <= spanSource.size() );
 
 		// Select a random position in the source where the tail end still fits the subspan size.
-		size_t sizeOffset = std::uniform_int_distribution< size_t >( 0, spanSource.size() - size )( generator );
+		size_t sizeOffset = RandomOffset( spanSource.size() - size, generator );
 		assert( sizeOffset + size <= spanSource.size() );
 		return spanSource.subspan( sizeOffset, size );
 	}
@@ -280,6 +510,89 @@ namespace AFLMutationFunctions::Details
 			return std::numeric_limits< uint64_t >::max();
 	}
 
+	//! Counts the integers of a sorted range that fit in each width in bytes from 0 to 8.
+	template< std::ranges::input_range Range >
+		requires std::unsigned_integral< std::ranges::range_value_t< Range > >
+	constexpr std::array< size_t, 9 > CountByWidth(
+		const Range& sorted  //!< Sorted integers.
+	)
+	{
+		// The integers are sorted, so the integers of each width are a prefix of the range.
+		std::array< size_t, 9 > arrayCounts { 0 };
+		for( size_t sizeWidth = 1; sizeWidth < arrayCounts.size(); sizeWidth++ )
+			arrayCounts[ sizeWidth ] = std::ranges::count_if( sorted, [ = ]( auto value ) {
+				return static_cast< size_t >( std::bit_width( value ) ) <= sizeWidth * 8;
+			} );
+		return arrayCounts;
+	}
+
+	//! Gets the number of interesting integers that fit in each width in bytes from 0 to 8.
+	constexpr auto GetInterestingCountsByWidth()
+	{
+		return CountByWidth( GetInterestingArray() );
+	}
+
+	//! Loads an unsigned integer of a fixed width from unaligned memory, applies a function and stores the result.
+	template< std::unsigned_integral T, class F >
+	void ApplyToUnaligned(
+		byte* pInteger,  //!< Beginning of the integer.
+		F&& fApply  //!< Function that is applied to the integer.
+	)
+	{
+		T value;
+		std::memcpy( &value, pInteger, sizeof( T ) );
+		value = static_cast< T >( fApply( value ) );
+		std::memcpy( pInteger, &value, sizeof( T ) );
+	}
+
+	/*!
+	Applies a function to the integer stored in a span of 1 to 8 bytes in native byte order.
+
+	Widths of 1, 2, 4 and 8 bytes are loaded and stored as integers of the same width. Other widths are
+	loaded to the first bytes of a zeroed 64-bit integer.
+	*/
+	template< class F >
+	void ApplyToInteger(
+		std::span< byte > spanInteger,  //!< Bytes of the integer.
+		F&& fApply  //!< Function that is applied to the integer.
+	)
+	{
+		// Use the fast paths for the widths of the integer types.
+		assert( ! spanInteger.empty() && spanInteger.size() <= sizeof( uint64_t ) );
+		switch( spanInteger.size() )
+		{
+		case 1:
+			ApplyToUnaligned< uint8_t >( spanInteger.data(), fApply );
+			break;
+		case 2:
+			ApplyToUnaligned< uint16_t >( spanInteger.data(), fApply );
+			break;
+		case 4:
+			ApplyToUnaligned< uint32_t >( spanInteger.data(), fApply );
+			break;
+		case 8:
+			ApplyToUnaligned< uint64_t >( spanInteger.data(), fApply );
+			break;
+		default:
+		{
+			uint64_t ui64Value = 0;
+			std::memcpy( &ui64Value, spanInteger.data(), spanInteger.size() );
+			ui64Value = fApply( ui64Value );
+			std::memcpy( spanInteger.data(), &ui64Value, spanInteger.size() );
+			break;
+		}
+		}
+	}
+
+	//! Stores the low bytes of an integer to a span of 1 to 8 bytes.
+	inline void StoreInteger(
+		std::span< byte > spanInteger,  //!< Bytes where the integer is stored.
+		uint64_t ui64Value  //!< Integer that is stored.
+	)
+	{
+		ApplyToInteger( spanInteger, [ = ]( auto ) { return ui64Value; } );
+	}
+
 	//! Helper functions that work with ranges.
 	namespace Ranges
 	{
@@ -295,7 +608,7 @@ namespace AFLMutationFunctions::Details
 		)
 		{
 			// Get an item from a random positon.
-			return std::ranges::begin( range )[ std::uniform_int_distribution< int >( 0, std::ranges::size( range ) - 1 )( gen ) ];
+			return std::ranges::begin( range )[ RandomInRange< size_t >( 0, std::ranges::size( range ) - 1, gen ) ];
 		}
 
 		//! Selects a random const value reference from a range.
@@ -309,13 +622,34 @@ namespace AFLMutationFunctions::Details
 		)
 		{
 			// Get an item from a random positon.
-			return std::ranges::begin( range )[ std::uniform_int_distribution< int >( 0, std::ranges::size( range ) - 1 )( gen ) ];
+			return std::ranges::begin( range )[ RandomInRange< size_t >( 0, std::ranges::size( range ) - 1, gen ) ];
 		}
 
-		//! Selects a random value from a non-sized range.
+		/*!
+		Selects a random value from a multi-pass range that is not random-access.
+
+		The range is traversed twice but no memory is allocated.
+		*/
 		template< class Gen, std::ranges::range Range >
 			requires ( std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+				std::ranges::forward_range< Range > &&
 				! std::ranges::random_access_range< Range > )
+		std::ranges::range_value_t< Range > SelectRandom(
+			Range& range,  //!< Range from where the random value is selected.
+			Gen&& gen  //!< Random number generator used as the source of randomness.
+		)
+		{
+			// Count the values and advance to a random position.
+			auto distance = std::ranges::distance( range );
+			assert( distance > 0 );
+			size_t offset = RandomInRange< size_t >( 0, distance - 1, gen );
+			return *std::ranges::next( std::ranges::begin( range ), offset );
+		}
+
+		//! Selects a random value from a single-pass range.
+		template< class Gen, std::ranges::range Range >
+			requires ( std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+				! std::ranges::forward_range< Range > )
 			std::ranges::range_value_t< Range > SelectRandom(
 					Range & range,  //!< Range from where the random value is selected.
 					Gen&& gen  //!< Random number generator used as the source of randomness.
@@ -342,6 +676,18 @@ namespace AFLMutationFunctions::Details
 			} -> std::convertible_to< bool >;
 		};
 
+		//! Gets whether a mutation can both grow and shrink the value. Mutations without IsResizing cannot.
+		template< SizeModifying T >
+		constexpr bool IsResizing(
+			const T& mutation  //!< Mutation that is checked.
+		)
+		{
+			if constexpr( requires { mutation.IsResizing(); } )
+				return mutation.IsResizing();
+			else
+				return false;
+		}
+
 		//! Filters out unsuitable mutations based on buffer and value sizes.
 		template< std::ranges::range Range >
 			requires SizeModifying< std::ranges::range_value_t< Range > >
@@ -354,7 +700,7 @@ namespace AFLMutationFunctions::Details
 			// Do not use increasing mutations if there is no space in the buffer.
 			bool bCanIncrease = sizeBuffer > sizeValue;
 
-			// Use only increasing mutations if value size is 0.
+			// Use only increasing and resizing mutations if value size is 0.
 			bool bMustIncrease = sizeValue == 0;
 
 			// Reducing mutations can only be used if value size exceeds 0,
@@ -366,7 +712,7 @@ namespace AFLMutationFunctions::Details
 			// Apply the conditional filters.
 			using std::views::filter;
 			return mutations |
-					filter( [ = ]( const auto& m ) { return ! bMustIncrease || m.IsIncreasing(); } ) |
+					filter( [ = ]( const auto& m ) { return ! bMustIncrease || m.IsIncreasing() || IsResizing( m ); } ) |
 					filter( [ = ]( const auto& m ) { return ! bMustReduce || m.IsReducing(); } ) |
 					filter( [ = ]( const auto& m ) { return bCanIncrease || ! m.IsIncreasing(); } );
 		}
@@ -385,7 +731,7 @@ namespace AFLMutationFunctions::Details
 			assert( size <= sourceSize );
 
 			// Select a starting position where the tail end will still fit the subrange.
-			size_t sizeOffset = std::uniform_int_distribution< size_t >( 0, sourceSize - size )( generator );
+			size_t sizeOffset = RandomOffset( sourceSize - size, generator );
 			assert( sizeOffset + size <= std::ranges::size( source ) );
 			auto begin = std::ranges::begin( source ) + sizeOffset;
 			auto end = std::ranges::begin( source ) + sizeOffset + size;
@@ -393,12 +739,544 @@ namespace AFLMutationFunctions::Details
 		}
 	}
 
+	//! Size states of a value that determine which mutations can be applied.
+	enum class SizeState
+	{
+		MustIncrease = 0,  //!< The value is empty.
+		CanIncrease,  //!< The buffer has space after the value.
+		CannotIncrease  //!< The value fills the whole buffer.
+	};
+
+	//! Gets the size state of a value. The value must fit in the buffer and the buffer must not be empty.
+	constexpr SizeState GetSizeState(
+		size_t sizeBuffer,  //!< Size of the buffer containing the value.
+		size_t sizeValue  //!< Size of the value in the buffer.
+	)
+	{
+		assert( sizeBuffer > 0 && sizeValue <= sizeBuffer );
+		if( sizeValue == 0 )
+			return SizeState::MustIncrease;
+		else if( sizeValue < sizeBuffer )
+			return SizeState::CanIncrease;
+		else
+			return SizeState::CannotIncrease;
+	}
+
+	/*!
+	Precomputed indices of the mutations that are suitable for each size state.
+
+	Selecting a mutation for a state is a single bounded random draw.
+	*/
+	template< size_t Capacity >
+		requires( Capacity <= std::numeric_limits< uint8_t >::max() )
+	class EligibleMutations
+	{
+	private:
+
+		//! Number of size states.
+		static constexpr size_t States = 3;
+
+		//! Indices of the suitable mutations for each state.
+		std::array< std::array< uint8_t, Capacity >, States > m_arrayIndices {};
+
+		//! Number of suitable mutations for each state.
+		std::array< size_t, States > m_arrayCounts {};
+
+	public:
+
+		//! Creates an empty set of eligible mutations.
+		constexpr EligibleMutations() = default;
+
+		//! Computes the suitable mutations for each size state.
+		template< std::ranges::contiguous_range Range >
+			requires Ranges::SizeModifying< std::ranges::range_value_t< Range > >
+		constexpr explicit EligibleMutations(
+			const Range& mutations  //!< Mutations that are classified.
+		)
+		{
+			// Representative buffer and value sizes for each state.
+			constexpr std::array< std::pair< size_t, size_t >, States > arraySizes { {
+					{ 1, 0 },  // SizeState::MustIncrease
+					{ 2, 1 },  // SizeState::CanIncrease
+					{ 1, 1 },  // SizeState::CannotIncrease
+			} };
+
+			// Store the positions of the mutations that pass the filter.
+			assert( std::ranges::size( mutations ) <= Capacity );
+			for( size_t state = 0; state < States; state++ )
+			{
+				auto [ sizeBuffer, sizeValue ] = arraySizes[ state ];
+				for( const auto& mutation : Ranges::FilterMutations( mutations, sizeBuffer, sizeValue ) )
+				{
+					auto index = std::addressof( mutation ) - std::ranges::data( mutations );
+					m_arrayIndices[ state ][ m_arrayCounts[ state ]++ ] = static_cast< uint8_t >( index );
+				}
+			}
+		}
+
+		//! Gets the indices of the mutations suitable for a size state.
+		constexpr std::span< const uint8_t > Get(
+			SizeState state  //!< Size state of the value.
+		) const
+		{
+			auto index = static_cast< size_t >( state );
+			return std::span { m_arrayIndices[ index ] }.subspan( 0, m_arrayCounts[ index ] );
+		}
+
+		//! Selects the index of a random mutation suitable for the size state. Some mutation must be suitable.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		size_t SelectRandom(
+			SizeState state,  //!< Size state of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+		{
+			return Ranges::SelectRandom( Get( state ), generator );
+		}
+	};
+
+	/*!
+	Concept for a generator that observes the steps of a havoc round.
+
+	Havoc calls BeginRound before the first step, BeginStep after a mutation is selected and
+	EndStep after it is applied. Draws made between BeginStep and EndStep belong to the mutation.
+	*/
+	template< class Gen >
+	concept StepObserver = requires( Gen& generator, size_t index ) {
+		generator.BeginRound();
+		generator.BeginStep( index );
+		generator.EndStep();
+	};
+
+	/*!
+	Concept for a generator that detects ineffective steps of a havoc round.
+
+	After EndStep, IneffectiveSteps gets the number of the latest steps that did not change the value:
+	1 if the step changed nothing and 2 if it undid the previous step. Havoc redraws these steps without
+	counting them against the number of iterations of the round.
+	*/
+	template< class Gen >
+	concept EffectObserver = StepObserver< Gen > && requires( const Gen& generator ) {
+		{
+			generator.IneffectiveSteps()
+		} -> std::convertible_to< unsigned int >;
+	};
+
+	//! Takes redraws of ineffective steps from the budget of a round. Returns the number of steps that are redrawn.
+	constexpr unsigned int TakeRedraws(
+		unsigned int uiIneffective,  //!< Number of ineffective steps.
+		unsigned int& uiBudget  //!< Number of redraws left in the round.
+	)
+	{
+		unsigned int uiTaken = std::min( uiIneffective, uiBudget );
+		uiBudget -= uiTaken;
+		return uiTaken;
+	}
+
+	/*!
+	Concept for a generator that observes the bytes written by the mutations.
+
+	The observer is notified before the bytes are written, so it can still read their old contents.
+	Offsets are relative to the beginning of the buffer passed to the mutation.
+	bResize is set when the write is part of a shift that changes the size of the value.
+	*/
+	template< class Gen >
+	concept WriteObserver = requires(
+			Gen& generator, std::span< const byte > spanBuffer, size_t sizeOffset, size_t size, bool bResize ) {
+		generator.OnWrite( spanBuffer, sizeOffset, size, bResize );
+	};
+
+	//! Notifies a generator that observes writes about a write. Does nothing for other generators.
+	template< class Gen >
+	constexpr void NotifyWrite(
+		Gen& generator,  //!< Random number generator used by the mutation.
+		std::span< const byte > spanBuffer,  //!< Buffer passed to the mutation.
+		size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the buffer.
+		size_t size,  //!< Number of written bytes.
+		bool bResize = false  //!< Whether the write is part of a shift that changes the size of the value.
+	)
+	{
+		if constexpr( WriteObserver< Gen > )
+		{
+			assert( sizeOffset + size <= spanBuffer.size() );
+			generator.OnWrite( spanBuffer, sizeOffset, size, bResize );
+		}
+	}
+
+	/*!
+	Concept for a generator that observes the bytes moved by the mutations.
+
+	The observer is notified before the bytes are moved. Offsets are relative to the beginning of the buffer
+	passed to the mutation. Moves are always part of a shift that changes the size of the value.
+	*/
+	template< class Gen >
+	concept MoveObserver = requires(
+			Gen& generator, std::span< const byte > spanBuffer, size_t sizeDestination, size_t sizeSource, size_t size ) {
+		generator.OnMove( spanBuffer, sizeDestination, sizeSource, size );
+	};
+
+	//! Notifies a generator about a move. Generators that only observe writes see a write of the destination.
+	template< class Gen >
+	constexpr void NotifyMove(
+		Gen& generator,  //!< Random number generator used by the mutation.
+		std::span< const byte > spanBuffer,  //!< Buffer passed to the mutation.
+		size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+		size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+		size_t size  //!< Number of moved bytes.
+	)
+	{
+		assert( std::max( sizeDestination, sizeSource ) + size <= spanBuffer.size() );
+		if constexpr( MoveObserver< Gen > )
+			generator.OnMove( spanBuffer, sizeDestination, sizeSource, size );
+		else
+			NotifyWrite( generator, spanBuffer, sizeDestination, size, true );
+	}
+
+	//! Notifies a generator that observes steps about the beginning of a round. Does nothing for other generators.
+	template< class Gen >
+	constexpr void NotifyBeginRound(
+		Gen& generator  //!< Random number generator used by havoc.
+	)
+	{
+		if constexpr( StepObserver< Gen > )
+			generator.BeginRound();
+	}
+
+	//! Notifies a generator that observes steps about the beginning of a step. Does nothing for other generators.
+	template< class Gen >
+	constexpr void NotifyBeginStep(
+		Gen& generator,  //!< Random number generator used by havoc.
+		size_t index  //!< Index of the mutation in the table.
+	)
+	{
+		if constexpr( StepObserver< Gen > )
+			generator.BeginStep( index );
+	}
+
+	//! Notifies a generator that observes steps about the end of a step. Does nothing for other generators.
+	template< class Gen >
+	constexpr void NotifyEndStep(
+		Gen& generator  //!< Random number generator used by havoc.
+	)
+	{
+		if constexpr( StepObserver< Gen > )
+			generator.EndStep();
+	}
+
+	/*!
+	Base of the random bit generator adaptors that forwards every hook of the wrapped generator.
+
+	Draws go to the wrapped generator. The dictionary, the corpus, step, write and move notifications, ineffective
+	steps and offset draws of the wrapped generator are exposed whenever it provides them, so adaptors can be
+	stacked in any order. An adaptor that implements a hook itself hides the forwarding member and must pass
+	the notification on with the Notify functions. Adaptors that observe writes must also observe moves, so
+	that moves reach a wrapped move observer. Gen can be a reference to wrap a generator that is not owned.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	class GeneratorAdaptor
+	{
+	public:
+
+		//! Type of the generated values.
+		using result_type = typename std::remove_reference_t< Gen >::result_type;
+
+	protected:
+
+		//! Generator that is wrapped.
+		Gen m_generator;
+
+	public:
+
+		//! Creates an adaptor with a default-constructed wrapped generator.
+		constexpr GeneratorAdaptor() = default;
+
+		//! Creates an adaptor of a generator.
+		constexpr explicit GeneratorAdaptor(
+			Gen generator  //!< Generator that is wrapped.
+		) :
+		m_generator { std::forward< Gen >( generator ) }
+		{
+		}
+
+		//! Gets the smallest value the generator produces.
+		static constexpr result_type min()
+		{
+			return std::remove_reference_t< Gen >::min();
+		}
+
+		//! Gets the largest value the generator produces.
+		static constexpr result_type max()
+		{
+			return std::remove_reference_t< Gen >::max();
+		}
+
+		//! Generates a value from the wrapped generator.
+		constexpr result_type operator()()
+		{
+			return m_generator();
+		}
+
+		//! Draws a uniformly distributed integer in range [low, high] from the wrapped generator.
+		constexpr uint64_t Uniform(
+			uint64_t low,  //!< Smallest possible value.
+			uint64_t high  //!< Largest possible value.
+		)
+		{
+			return RandomInRange( low, high, m_generator );
+		}
+
+		//! Gets the dictionary of the wrapped generator.
+		constexpr decltype( auto ) GetDictionary() const
+			requires requires( const Gen& generator ) { generator.GetDictionary(); }
+		{
+			return m_generator.GetDictionary();
+		}
+
+		//! Gets the corpus of the wrapped generator.
+		constexpr decltype( auto ) GetCorpus() const
+			requires requires( const Gen& generator ) { generator.GetCorpus(); }
+		{
+			return m_generator.GetCorpus();
+		}
+
+		//! Forwards the beginning of a round.
+		constexpr void BeginRound()
+			requires StepObserver< Gen >
+		{
+			m_generator.BeginRound();
+		}
+
+		//! Forwards the beginning of a step.
+		constexpr void BeginStep(
+			size_t index  //!< Index of the mutation in the table.
+		)
+			requires StepObserver< Gen >
+		{
+			m_generator.BeginStep( index );
+		}
+
+		//! Forwards the end of a step.
+		constexpr void EndStep()
+			requires StepObserver< Gen >
+		{
+			m_generator.EndStep();
+		}
+
+		//! Gets the number of the latest ineffective steps detected by the wrapped generator.
+		constexpr unsigned int IneffectiveSteps() const
+			requires EffectObserver< Gen >
+		{
+			return m_generator.IneffectiveSteps();
+		}
+
+		//! Forwards a write.
+		constexpr void OnWrite(
+			std::span< const byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the buffer.
+			size_t size,  //!< Number of written bytes.
+			bool bResize  //!< Whether the write is part of a shift that changes the size of the value.
+		)
+			requires WriteObserver< Gen >
+		{
+			m_generator.OnWrite( spanBuffer, sizeOffset, size, bResize );
+		}
+
+		//! Forwards a move.
+		constexpr void OnMove(
+			std::span< const byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+			size_t size  //!< Number of moved bytes.
+		)
+			requires MoveObserver< Gen >
+		{
+			m_generator.OnMove( spanBuffer, sizeDestination, sizeSource, size );
+		}
+
+		//! Draws the offset of a position from the wrapped generator.
+		constexpr size_t DrawOffset(
+			size_t sizeMax  //!< Largest possible offset.
+		)
+			requires OffsetSource< Gen >
+		{
+			return m_generator.DrawOffset( sizeMax );
+		}
+
+		//! Gets the wrapped generator.
+		constexpr const Gen& Base() const
+		{
+			return m_generator;
+		}
+
+		//! Gets the wrapped generator, for example to revert its journal.
+		constexpr Gen& Base()
+		{
+			return m_generator;
+		}
+	};
+
+	/*!
+	Copies bytes between possibly overlapping ranges.
+
+	The C library implementation selects vectorized code for the running CPU, so this is used instead of
+	relying on the optimizer to lower iterator-based algorithms to it.
+	*/
+	inline void MoveBytes(
+		byte* pDestination,  //!< Beginning of the destination.
+		const byte* pSource,  //!< Beginning of the source.
+		size_t size  //!< Number of bytes copied.
+	) noexcept
+	{
+		if( size > 0 && pDestination != pSource )
+			std::memmove( pDestination, pSource, size );
+	}
+
+	//! Sets every byte of a range to a value.
+	inline void FillBytes(
+		std::span< byte > span,  //!< Bytes that are set.
+		byte value  //!< Value that is repeated.
+	) noexcept
+	{
+		if( ! span.empty() )
+			std::memset( span.data(), std::to_integer< int >( value ), span.size() );
+	}
+
+	//! Concept for a policy that clones a block of bytes to a possibly overlapping destination.
+	template< class Clone >
+	concept ClonePolicy = requires( byte* pDestination, const byte* pSource, size_t size ) {
+		Clone::Move( pDestination, pSource, size );
+	};
+
+	//! Clones every block with a single overlapping move.
+	struct DirectClone
+	{
+		//! Moves the bytes directly.
+		static void Move(
+			byte* pDestination,  //!< Beginning of the destination.
+			const byte* pSource,  //!< Beginning of the source.
+			size_t size  //!< Number of bytes copied.
+		) noexcept
+		{
+			MoveBytes( pDestination, pSource, size );
+		}
+	};
+
+	/*!
+	Clones blocks of at most Threshold bytes through a scratch on the stack and larger blocks with an
+	overlapping move.
+
+	Blocks of up to 16 bytes are loaded to registers with two overlapping loads before they are stored, which
+	avoids the call to memmove. Larger blocks up to the threshold are loaded to a scratch array in 16-byte
+	chunks, the last of which ends at the end of the block, before they are stored.
+	*/
+	template< size_t Threshold = 64 >
+		requires ( Threshold > 0 )
+	struct ScratchClone
+	{
+		//! Size of a chunk of the scratch array.
+		static constexpr size_t ScratchChunk = 16;
+
+		//! Gets whether a block is moved in chunks of the scratch array rather than with two loads or an overlapping move.
+		static constexpr bool IsScratchCopy(
+			size_t size  //!< Number of bytes copied.
+		)
+		{
+			return size > ScratchChunk && size <= Threshold;
+		}
+
+		//! Moves the bytes through the scratch array if they fit.
+		static void Move(
+			byte* pDestination,  //!< Beginning of the destination.
+			const byte* pSource,  //!< Beginning of the source.
+			size_t size  //!< Number of bytes copied.
+		) noexcept
+		{
+			if( size > Threshold || pDestination == pSource )
+				MoveBytes( pDestination, pSource, size );
+			else if( IsScratchCopy( size ) )
+				MoveScratch( pDestination, pSource, size );
+			else if( size >= 8 )
+				MoveSmall< uint64_t >( pDestination, pSource, size );
+			else if( size >= 4 )
+				MoveSmall< uint32_t >( pDestination, pSource, size );
+			else
+				MoveSmall< uint8_t >( pDestination, pSource, size );
+		}
+
+	private:
+
+		/*!
+		Moves more than 16 bytes by loading every chunk before storing them.
+
+		Every call loads the chunk at Index, moves the chunks after it and then stores its chunk. The last chunk
+		ends at the end of the block and may overlap the others. The chunks are loaded at constant offsets, so they
+		stay in vector registers.
+		*/
+		template< size_t Index = 0 >
+		static void MoveScratch(
+			byte* pDestination,  //!< Beginning of the destination.
+			const byte* pSource,  //!< Beginning of the source.
+			size_t size  //!< Number of bytes copied.
+		) noexcept
+		{
+			std::array< byte, ScratchChunk > arrayChunk;
+			if constexpr( ( Index + 1 ) * ScratchChunk < Threshold )
+			{
+				if( ( Index + 1 ) * ScratchChunk < size )
+				{
+					std::memcpy( arrayChunk.data(), pSource + Index * ScratchChunk, ScratchChunk );
+					MoveScratch< Index + 1 >( pDestination, pSource, size );
+					std::memcpy( pDestination + Index * ScratchChunk, arrayChunk.data(), ScratchChunk );
+					return;
+				}
+			}
+			std::memcpy( arrayChunk.data(), pSource + size - ScratchChunk, ScratchChunk );
+			std::memcpy( pDestination + size - ScratchChunk, arrayChunk.data(), ScratchChunk );
+		}
+
+		/*!
+		Moves 1 to 3 bytes, or between sizeof( T ) and 2 * sizeof( T ) bytes, by loading the first and the last
+		sizeof( T ) bytes before storing them.
+		*/
+		template< class T >
+		static void MoveSmall(
+			byte* pDestination,  //!< Beginning of the destination.
+			const byte* pSource,  //!< Beginning of the source.
+			size_t size  //!< Number of bytes copied.
+		) noexcept
+		{
+			if constexpr( sizeof( T ) == 1 )
+			{
+				// Load the first, middle and last bytes, which cover up to 3 bytes.
+				if( size == 0 )
+					return;
+				byte byteFirst = pSource[ 0 ];
+				byte byteMiddle = pSource[ size / 2 ];
+				byte byteLast = pSource[ size - 1 ];
+				pDestination[ 0 ] = byteFirst;
+				pDestination[ size / 2 ] = byteMiddle;
+				pDestination[ size - 1 ] = byteLast;
+			}
+			else
+			{
+				T first;
+				T last;
+				std::memcpy( &first, pSource, sizeof( T ) );
+				std::memcpy( &last, pSource + size - sizeof( T ), sizeof( T ) );
+				std::memcpy( pDestination, &first, sizeof( T ) );
+				std::memcpy( pDestination + size - sizeof( T ), &last, sizeof( T ) );
+			}
+		}
+	};
+
 	/*!
 	Fills a subrange with random values. The random values may be copied from the subrange.
 
 	std::ranges::begin( subrange ) must be within the range [std::ranges::begin( range ), std::ranges::end( range )).
+	Contiguous bytes are cloned with the clone policy.
 	*/
-	template< std::ranges::sized_range Range, std::ranges::sized_range SubRange, class Gen >
+	template< ClonePolicy Clone = DirectClone, std::ranges::sized_range Range, std::ranges::sized_range SubRange, class Gen >
 	void FillSubrangeWithRandomValues(
 		const Range& range,  //!< Range that contains some values that may be used as the random data.
 		const SubRange& subrange,  //!< Subrange in range (or super range or range) that is filled with random data.
@@ -407,14 +1285,20 @@ namespace AFLMutationFunctions::Details
 	{
 		// Clone bytes with 0.75 probability. Otherwise repeat a random byte.
 		std::ranges::range_size_t< Range > rangeSize = std::ranges::size( range );
-		if( rangeSize > 1 && std::uniform_int_distribution( 0, 3 )( generator ) != 0 )
+		if( rangeSize > 1 && RandomInRange( 0u, 3u, generator ) != 0 )
 		{
 			// Clone a random block.
 
 			// Select a random subspan from the value and copy those bytes to the random block.
 			auto source = Ranges::SelectRandomSubrange(
 					range, std::min( rangeSize, std::ranges::size( subrange ) ), generator );
-			if( std::begin( source ) < std::begin( subrange ) )
+			if constexpr( std::ranges::contiguous_range< SubRange > &&
+					std::same_as< std::ranges::range_value_t< SubRange >, byte > )
+			{
+				// Contiguous bytes are moved in either direction at once.
+				Clone::Move( std::ranges::data( subrange ), std::ranges::data( source ), std::ranges::size( source ) );
+			}
+			else if( std::begin( source ) < std::begin( subrange ) )
 			{
 				// Copy right.
 				auto copyEnd = std::begin( subrange ) + std::ranges::distance( source );
@@ -433,13 +1317,17 @@ namespace AFLMutationFunctions::Details
 
 			// Either repatedly copy a random byte from the buffer or a randomly generated byte.
 			byte byteRandom;
-			if( rangeSize > 0 && std::uniform_int_distribution( 0, 1 )( generator ) == 0 )
+			if( rangeSize > 0 && RandomInRange( 0u, 1u, generator ) == 0 )
 				byteRandom = Details::Ranges::SelectRandom( range, generator );
 			else
-				byteRandom = static_cast< byte >( std::uniform_int_distribution( 0, 255 )( generator ) );
+				byteRandom = static_cast< byte >( RandomInRange( 0u, 255u, generator ) );
 
 			// Fill the random block with the repeated byte.
-			std::ranges::fill( subrange, byteRandom );
+			if constexpr( std::ranges::contiguous_range< SubRange > &&
+					std::same_as< std::ranges::range_value_t< SubRange >, byte > )
+				FillBytes( std::span { std::ranges::data( subrange ), std::ranges::size( subrange ) }, byteRandom );
+			else
+				std::ranges::fill( subrange, byteRandom );
 		}
 	}
 }
@@ -0,0 +1,281 @@
+/*! \file
+Deterministic stages of AFL that walk every position of a value.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Deterministic stages in the order they are applied.
+	enum class DeterministicStage : uint8_t
+	{
+		Flip1 = 0,  //!< Flips every bit.
+		Flip2,  //!< Flips every two consecutive bits.
+		Flip4,  //!< Flips every four consecutive bits.
+		Flip8,  //!< Inverts every byte.
+		Flip16,  //!< Inverts every two consecutive bytes.
+		Flip32,  //!< Inverts every four consecutive bytes.
+		Arith8,  //!< Adds and subtracts small deltas to every byte.
+		Arith16,  //!< Adds and subtracts small deltas to every 16-bit integer in both endians.
+		Arith32,  //!< Adds and subtracts small deltas to every 32-bit integer in both endians.
+		Interesting8,  //!< Writes interesting 8-bit integers to every byte.
+		Interesting16,  //!< Writes interesting 16-bit integers to every 16-bit integer.
+		Interesting32,  //!< Writes interesting 32-bit integers to every 32-bit integer.
+		Done  //!< Every stage was applied.
+	};
+
+	//! Position of a deterministic mutator in its stages. Can be stored to resume the stages later.
+	struct DeterministicCursor
+	{
+		DeterministicStage stage = DeterministicStage::Flip1;  //!< Current stage.
+		size_t sizePosition = 0;  //!< Bit or byte position in the stage.
+		size_t sizeVariant = 0;  //!< Index of the mutation at the position.
+	};
+
+	/*!
+	Lazy generator of the mutants of the deterministic stages of AFL.
+
+	Every call to Next restores the previous mutant and applies the next mutation, so the buffer holds the seed
+	with exactly one deterministic mutation. The arithmetic stages use the deltas and endians of
+	ArithmeticSmallDelta and the interesting stages write the integers of the interesting table, which already
+	contains their endian-swapped versions. Mutations that would not change the value are skipped.
+
+	Positions whose bit is cleared in the effector map are skipped. Multi-byte mutations are applied if any of
+	their bytes is effective. Bytes beyond the end of the map are effective.
+	*/
+	template< const auto& Table = DefaultInterestingTable >
+	class DeterministicMutator
+	{
+	private:
+
+		//! Current position in the stages.
+		DeterministicCursor m_cursor;
+
+		//! Effector map with one bit per byte of the value.
+		std::span< const uint64_t > m_spanEffector;
+
+		//! Original bytes changed by the latest mutant.
+		std::array< byte, 4 > m_arraySaved {};
+
+		//! Offset of the original bytes.
+		size_t m_sizeSavedOffset = 0;
+
+		//! Number of original bytes.
+		size_t m_sizeSaved = 0;
+
+	public:
+
+		//! Creates a mutator that starts from the first stage or resumes from a cursor.
+		constexpr explicit DeterministicMutator(
+			std::span< const uint64_t > spanEffector = {},  //!< Effector map. Every byte is effective if empty.
+			DeterministicCursor cursor = {}  //!< Position where the stages are resumed.
+		) :
+		m_cursor { cursor },
+		m_spanEffector { spanEffector }
+		{
+		}
+
+		/*!
+		Restores the previous mutant and applies the next deterministic mutation in place.
+
+		The value must be the same for every call. Returns false and leaves the seed in the buffer when every
+		mutant was produced.
+		*/
+		bool Next(
+			std::span< byte > spanValue  //!< Value that is mutated.
+		)
+		{
+			Restore( spanValue );
+			while( m_cursor.stage != DeterministicStage::Done )
+			{
+				// Move to the next stage when every position was visited.
+				size_t sizeWidth = GetWidth( m_cursor.stage );
+				size_t sizePositions = GetPositions( m_cursor.stage, spanValue.size() );
+				if( m_cursor.sizePosition >= sizePositions )
+				{
+					m_cursor = DeterministicCursor { static_cast< DeterministicStage >( static_cast< uint8_t >( m_cursor.stage ) + 1 ), 0, 0 };
+					continue;
+				}
+
+				// Skip positions without effective bytes.
+				size_t sizeOffset = IsBitStage( m_cursor.stage ) ? m_cursor.sizePosition / 8 : m_cursor.sizePosition;
+				size_t sizeTouched = IsBitStage( m_cursor.stage ) ? ( m_cursor.sizePosition % 8 + sizeWidth - 1 ) / 8 + 1 : sizeWidth;
+				if( ! IsEffective( sizeOffset, sizeTouched ) )
+				{
+					m_cursor.sizePosition++;
+					m_cursor.sizeVariant = 0;
+					continue;
+				}
+
+				// Apply the variant and advance to the next one.
+				DeterministicCursor cursor = m_cursor;
+				if( ++m_cursor.sizeVariant == GetVariants( m_cursor.stage ) )
+				{
+					m_cursor.sizePosition++;
+					m_cursor.sizeVariant = 0;
+				}
+				std::span< byte > spanTouched = spanValue.subspan( sizeOffset, sizeTouched );
+				std::ranges::copy( spanTouched, m_arraySaved.begin() );
+				Apply( cursor, spanTouched );
+				if( std::ranges::equal( spanTouched, std::span { m_arraySaved }.first( sizeTouched ) ) )
+					continue;
+				m_sizeSavedOffset = sizeOffset;
+				m_sizeSaved = sizeTouched;
+				return true;
+			}
+			return false;
+		}
+
+		//! Restores the seed from the latest mutant.
+		void Restore(
+			std::span< byte > spanValue  //!< Value that was mutated.
+		)
+		{
+			assert( m_sizeSavedOffset + m_sizeSaved <= spanValue.size() );
+			std::ranges::copy( std::span { m_arraySaved }.first( m_sizeSaved ), spanValue.begin() + m_sizeSavedOffset );
+			m_sizeSaved = 0;
+		}
+
+		//! Replaces the effector map. Positions that were already visited are not revisited.
+		constexpr void SetEffectorMap(
+			std::span< const uint64_t > spanEffector  //!< Effector map. Every byte is effective if empty.
+		)
+		{
+			m_spanEffector = spanEffector;
+		}
+
+		//! Gets the position of the next mutation.
+		constexpr DeterministicCursor GetCursor() const
+		{
+			return m_cursor;
+		}
+
+		//! Gets the number of mutants of a value of a size if every byte is effective, including mutants that are skipped as unchanged.
+		static constexpr size_t CountMutants(
+			size_t sizeValue  //!< Size of the value.
+		)
+		{
+			size_t sizeMutants = 0;
+			for( uint8_t i = 0; i < static_cast< uint8_t >( DeterministicStage::Done ); i++ )
+			{
+				DeterministicStage stage = static_cast< DeterministicStage >( i );
+				sizeMutants += GetPositions( stage, sizeValue ) * GetVariants( stage );
+			}
+			return sizeMutants;
+		}
+
+	private:
+
+		//! Gets whether a stage walks bits rather than bytes.
+		static constexpr bool IsBitStage(
+			DeterministicStage stage  //!< Stage of the mutation.
+		)
+		{
+			return stage <= DeterministicStage::Flip4;
+		}
+
+		//! Gets the number of bits or bytes mutated at every position of a stage.
+		static constexpr size_t GetWidth(
+			DeterministicStage stage  //!< Stage of the mutation.
+		)
+		{
+			constexpr std::array< size_t, 12 > arrayWidths { 1, 2, 4, 1, 2, 4, 1, 2, 4, 1, 2, 4 };
+			return arrayWidths[ static_cast< uint8_t >( stage ) ];
+		}
+
+		//! Gets the number of positions of a stage in a value.
+		static constexpr size_t GetPositions(
+			DeterministicStage stage,  //!< Stage of the mutation.
+			size_t sizeValue  //!< Size of the value.
+		)
+		{
+			size_t sizeUnits = IsBitStage( stage ) ? sizeValue * 8 : sizeValue;
+			size_t sizeWidth = GetWidth( stage );
+			return sizeUnits >= sizeWidth ? sizeUnits - sizeWidth + 1 : 0;
+		}
+
+		//! Gets the number of mutations at every position of a stage.
+		static constexpr size_t GetVariants(
+			DeterministicStage stage  //!< Stage of the mutation.
+		)
+		{
+			size_t sizeWidth = GetWidth( stage );
+			if( stage >= DeterministicStage::Interesting8 )
+				return Table.arrayCountsByWidth[ sizeWidth ];
+			else if( stage >= DeterministicStage::Arith8 )
+				return ArithmeticMaxDelta * ( sizeWidth == 1 ? 2 : 4 );
+			else
+				return 1;
+		}
+
+		//! Gets whether any byte of a range is effective.
+		constexpr bool IsEffective(
+			size_t sizeOffset,  //!< Offset of the first byte.
+			size_t size  //!< Number of bytes.
+		) const
+		{
+			if( m_spanEffector.empty() )
+				return true;
+			for( size_t i = sizeOffset; i < sizeOffset + size; i++ )
+			{
+				if( i / 64 >= m_spanEffector.size() || ( m_spanEffector[ i / 64 ] >> ( i % 64 ) & 1 ) != 0 )
+					return true;
+			}
+			return false;
+		}
+
+		//! Applies the mutation at a cursor to the bytes it touches.
+		static void Apply(
+			const DeterministicCursor& cursor,  //!< Position of the mutation.
+			std::span< byte > spanTouched  //!< Bytes touched by the mutation.
+		)
+		{
+			DeterministicStage stage = cursor.stage;
+			size_t sizeWidth = GetWidth( stage );
+			size_t sizeVariant = cursor.sizeVariant;
+			if( IsBitStage( stage ) )
+			{
+				// Flip the bits starting from the most significant bit of the first byte like AFL.
+				size_t sizeFirstBit = cursor.sizePosition % 8;
+				for( size_t i = sizeFirstBit; i < sizeFirstBit + sizeWidth; i++ )
+					spanTouched[ i / 8 ] ^= byte { 0x80 } >> ( i % 8 );
+			}
+			else if( stage <= DeterministicStage::Flip32 )
+			{
+				// Invert the bytes.
+				for( byte& b : spanTouched )
+					b = ~b;
+			}
+			else if( stage <= DeterministicStage::Arith32 )
+			{
+				// Apply the delta in the selected endian.
+				size_t sizeKinds = sizeWidth == 1 ? 2 : 4;
+				uint64_t ui64Delta = sizeVariant / sizeKinds + 1;
+				bool bSubtract = ( sizeVariant & 1 ) != 0;
+				bool bSwap = ( sizeVariant & 2 ) != 0;
+				Details::ApplyToInteger( spanTouched, [ = ]( auto value ) {
+					using T = decltype( value );
+					if( bSwap )
+						value = Details::SwapEndian( value );
+					uint64_t ui64Value = static_cast< uint64_t >( value );
+					value = static_cast< T >( bSubtract ? std::minus< uint64_t > {}( ui64Value, ui64Delta ) : std::plus< uint64_t > {}( ui64Value, ui64Delta ) );
+					return bSwap ? Details::SwapEndian( value ) : value;
+				} );
+			}
+			else
+			{
+				// Write the interesting integer.
+				Details::StoreInteger( spanTouched, Table.arrayValues[ sizeVariant ] );
+			}
+		}
+	};
+}
@@ -0,0 +1,222 @@
+/*! \file
+Dictionary of tokens and the mutations that write them to values.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Store of the tokens of a dictionary.
+
+	The bytes of every token are kept in one contiguous arena, sorted by token length. An index of the first token
+	of every length makes selecting a random token that fits a number of bytes a constant-time operation.
+	*/
+	class TokenDictionary
+	{
+	public:
+
+		//! Size of the longest token that can be added.
+		static constexpr size_t MaxTokenSize = 128;
+
+	private:
+
+		//! Bytes of the tokens sorted by length.
+		std::vector< byte > m_vecArena;
+
+		//! Offsets of the tokens in the arena followed by the size of the arena.
+		std::vector< uint32_t > m_vecOffsets { 0 };
+
+		//! Index of the first token with at least the size of the array index.
+		std::array< uint32_t, MaxTokenSize + 2 > m_arrayFirstWithSize {};
+
+	public:
+
+		//! Adds a token. Returns false if the token is empty or longer than MaxTokenSize.
+		bool Add(
+			std::span< const byte > spanToken  //!< Bytes of the token.
+		)
+		{
+			if( spanToken.empty() || spanToken.size() > MaxTokenSize )
+				return false;
+
+			// Insert the token after the other tokens of the same size.
+			size_t index = m_arrayFirstWithSize[ spanToken.size() + 1 ];
+			uint32_t ui32Offset = m_vecOffsets[ index ];
+			m_vecArena.insert( m_vecArena.begin() + ui32Offset, spanToken.begin(), spanToken.end() );
+			m_vecOffsets.insert( m_vecOffsets.begin() + index, ui32Offset );
+			for( size_t i = index + 1; i < m_vecOffsets.size(); i++ )
+				m_vecOffsets[ i ] += static_cast< uint32_t >( spanToken.size() );
+
+			// Longer tokens moved by one.
+			for( size_t i = spanToken.size() + 1; i < m_arrayFirstWithSize.size(); i++ )
+				m_arrayFirstWithSize[ i ]++;
+			return true;
+		}
+
+		//! Gets the number of tokens.
+		size_t Size() const
+		{
+			return m_vecOffsets.size() - 1;
+		}
+
+		//! Gets whether the dictionary has no tokens.
+		bool Empty() const
+		{
+			return Size() == 0;
+		}
+
+		//! Gets the number of tokens that are not longer than a number of bytes.
+		size_t CountFitting(
+			size_t size  //!< Number of bytes available for the token.
+		) const
+		{
+			return m_arrayFirstWithSize[ std::min( size, MaxTokenSize ) + 1 ];
+		}
+
+		//! Gets a token. Tokens are sorted by size.
+		std::span< const byte > Get(
+			size_t index  //!< Index of the token.
+		) const
+		{
+			assert( index < Size() );
+			return std::span { m_vecArena }.subspan( m_vecOffsets[ index ], m_vecOffsets[ index + 1 ] - m_vecOffsets[ index ] );
+		}
+
+		/*!
+		Selects a random token that is not longer than a number of bytes.
+
+		Returns an empty span if no token fits.
+		*/
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		std::span< const byte > SelectFitting(
+			size_t size,  //!< Number of bytes available for the token.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+		{
+			size_t sizeFitting = CountFitting( size );
+			if( sizeFitting == 0 )
+				return {};
+			return Get( Details::RandomInRange< size_t >( 0, sizeFitting - 1, generator ) );
+		}
+	};
+
+	namespace Details
+	{
+		//! Concept for a random number generator that provides a dictionary to the dictionary mutations.
+		template< class Gen >
+		concept DictionarySource = requires( const Gen& generator ) {
+			{
+				generator.GetDictionary()
+			} -> std::same_as< const TokenDictionary& >;
+		};
+	}
+
+	/*!
+	Random bit generator adaptor that provides a dictionary to the dictionary mutations.
+
+	The dictionary is not owned, so every worker can share one dictionary. The other hooks of the base generator
+	are forwarded, so it can be combined with the other adaptors.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< Gen >
+	class DictionaryGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		//! Tokens written by the dictionary mutations.
+		const TokenDictionary* m_pDictionary;
+
+	public:
+
+		//! Creates a dictionary generator from a base generator.
+		DictionaryGenerator(
+			Gen generator,  //!< Generator that provides the randomness.
+			const TokenDictionary& dictionary  //!< Tokens written by the dictionary mutations. Must outlive the generator.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) },
+		m_pDictionary { &dictionary }
+		{
+		}
+
+		//! Gets the dictionary.
+		const TokenDictionary& GetDictionary() const
+		{
+			return *m_pDictionary;
+		}
+	};
+
+	/*!
+	Overwrites a random location in the buffer with a random dictionary token that fits the buffer.
+
+	The buffer is not modified if no token fits.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+			Details::DictionarySource< std::remove_reference_t< Gen > >
+	void DictionaryOverwrite(
+		std::span< byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Select a token that fits the buffer.
+		std::span< const byte > spanToken = generator.GetDictionary().SelectFitting( spanBuffer.size(), generator );
+		if( spanToken.empty() )
+			return;
+
+		// Copy the token to a random location.
+		std::span< byte > spanRandomSubspan = Details::SelectRandomSubspan( spanBuffer, spanToken.size(), generator );
+		Details::NotifyWrite( generator, spanBuffer, spanRandomSubspan.data() - spanBuffer.data(), spanToken.size() );
+		std::ranges::copy( spanToken, spanRandomSubspan.begin() );
+	}
+
+	/*!
+	Inserts a random dictionary token that fits the free space of the buffer to a random position in the value.
+
+	The buffer will be mutated from [Head | Tail] to [Head | Token | Tail]. The value is not modified if no token fits.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+			Details::DictionarySource< std::remove_reference_t< Gen > >
+	std::span< byte > DictionaryInsert(
+		std::span< byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// There must be some extra space in the buffer.
+		assert( sizeValue < spanBuffer.size() );
+
+		// Select a token that fits the free space.
+		std::span< const byte > spanToken = generator.GetDictionary().SelectFitting( spanBuffer.size() - sizeValue, generator );
+		if( spanToken.empty() )
+			return spanBuffer.subspan( 0, sizeValue );
+
+		// Move the tail of the value after the token.
+		size_t sizeBegin = Details::RandomInRange< size_t >( 0, sizeValue, generator );
+		Details::NotifyMove( generator, spanBuffer, sizeBegin + spanToken.size(), sizeBegin, sizeValue - sizeBegin );
+		Details::MoveBytes( spanBuffer.data() + sizeBegin + spanToken.size(), spanBuffer.data() + sizeBegin, sizeValue - sizeBegin );
+
+		// Copy the token to the gap.
+		Details::NotifyWrite( generator, spanBuffer, sizeBegin, spanToken.size(), true );
+		std::ranges::copy( spanToken, spanBuffer.begin() + sizeBegin );
+
+		// Return the span of the new value.
+		return spanBuffer.subspan( 0, sizeValue + spanToken.size() );
+	}
+
+	//! Default mutations followed by the dictionary mutations.
+	template< class Gen >
+	using DictionaryOps = JoinOps< DefaultOps< Gen >, Ops< DictionaryOverwrite< Gen >, DictionaryInsert< Gen > > >;
+}
@@ -0,0 +1,244 @@
+/*! \file
+Tracking of the byte ranges changed by havoc rounds.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Range of bytes that a havoc round may have changed.
+
+	The layout is fixed so that a list of ranges can be shared with executors in other processes.
+	*/
+	struct DirtyRange
+	{
+		uint64_t ui64Offset = 0;  //!< Offset of the range from the beginning of the buffer.
+		uint64_t ui64Size = 0;  //!< Size of the range.
+		uint64_t ui64SizeChanged = 0;  //!< Non-zero if the range was written by a mutation that changed the size of the value.
+	};
+	static_assert( std::is_standard_layout_v< DirtyRange > && std::is_trivially_copyable_v< DirtyRange > );
+
+	/*!
+	Sorted, disjoint list of dirty ranges with a fixed capacity.
+
+	Overlapping and adjacent ranges are merged. When the list is full, the two ranges with the smallest gap
+	are merged, so the list always covers every changed byte.
+	*/
+	template< size_t Capacity = 16 >
+		requires( Capacity > 0 )
+	class DirtyRanges
+	{
+	private:
+
+		//! Ranges sorted by offset.
+		std::array< DirtyRange, Capacity + 1 > m_arrayRanges {};
+
+		//! Number of ranges.
+		size_t m_sizeRanges = 0;
+
+	public:
+
+		//! Removes every range.
+		constexpr void Clear()
+		{
+			m_sizeRanges = 0;
+		}
+
+		//! Adds a range.
+		constexpr void Add(
+			size_t sizeOffset,  //!< Offset of the range from the beginning of the buffer.
+			size_t size,  //!< Size of the range.
+			bool bSizeChanged  //!< Whether the range was written by a mutation that changed the size of the value.
+		)
+		{
+			if( size == 0 )
+				return;
+
+			// Insert the range in order.
+			size_t index = 0;
+			while( index < m_sizeRanges && m_arrayRanges[ index ].ui64Offset <= sizeOffset )
+				index++;
+			std::copy_backward( m_arrayRanges.begin() + index, m_arrayRanges.begin() + m_sizeRanges,
+					m_arrayRanges.begin() + m_sizeRanges + 1 );
+			m_arrayRanges[ index ] = DirtyRange { sizeOffset, size, bSizeChanged };
+			m_sizeRanges++;
+
+			// Merge the ranges touching the new range.
+			if( index > 0 && Touches( index - 1 ) )
+				Merge( --index );
+			while( index + 1 < m_sizeRanges && Touches( index ) )
+				Merge( index );
+
+			// Merge the closest ranges if the list overflowed.
+			if( m_sizeRanges > Capacity )
+			{
+				size_t sizeClosest = 0;
+				for( size_t i = 1; i + 1 < m_sizeRanges; i++ )
+				{
+					if( Gap( i ) < Gap( sizeClosest ) )
+						sizeClosest = i;
+				}
+				Merge( sizeClosest );
+			}
+		}
+
+		//! Gets the ranges.
+		constexpr std::span< const DirtyRange > Get() const
+		{
+			return std::span { m_arrayRanges }.subspan( 0, m_sizeRanges );
+		}
+
+		//! Gets whether any range was written by a mutation that changed the size of the value.
+		constexpr bool SizeChanged() const
+		{
+			return std::ranges::any_of( Get(), []( const DirtyRange& range ) { return range.ui64SizeChanged != 0; } );
+		}
+
+	private:
+
+		//! Gets the number of clean bytes between a range and the next range.
+		constexpr uint64_t Gap(
+			size_t index  //!< Index of the first range.
+		) const
+		{
+			const DirtyRange& first = m_arrayRanges[ index ];
+			return m_arrayRanges[ index + 1 ].ui64Offset - ( first.ui64Offset + first.ui64Size );
+		}
+
+		//! Gets whether a range overlaps or is adjacent to the next range.
+		constexpr bool Touches(
+			size_t index  //!< Index of the first range.
+		) const
+		{
+			const DirtyRange& first = m_arrayRanges[ index ];
+			return m_arrayRanges[ index + 1 ].ui64Offset <= first.ui64Offset + first.ui64Size;
+		}
+
+		//! Merges a range with the next range.
+		constexpr void Merge(
+			size_t index  //!< Index of the first range.
+		)
+		{
+			DirtyRange& first = m_arrayRanges[ index ];
+			const DirtyRange& second = m_arrayRanges[ index + 1 ];
+			first.ui64Size = std::max( first.ui64Offset + first.ui64Size, second.ui64Offset + second.ui64Size ) - first.ui64Offset;
+			first.ui64SizeChanged |= second.ui64SizeChanged;
+			std::copy( m_arrayRanges.begin() + index + 2, m_arrayRanges.begin() + m_sizeRanges, m_arrayRanges.begin() + index + 1 );
+			m_sizeRanges--;
+		}
+	};
+
+	/*!
+	Random bit generator adaptor that collects the ranges written by havoc rounds.
+
+	Every round replaces the ranges of the previous round. Offsets are relative to the buffer passed to havoc.
+	*/
+	template< class Gen, size_t Capacity = 16 >
+		requires std::uniform_random_bit_generator< Gen >
+	class DirtyRangeGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		using Details::GeneratorAdaptor< Gen >::m_generator;
+
+		//! Ranges written in the latest round.
+		DirtyRanges< Capacity > m_ranges;
+
+	public:
+
+		//! Creates a tracker with a default-constructed base generator.
+		constexpr DirtyRangeGenerator() = default;
+
+		//! Creates a tracker from a base generator.
+		constexpr explicit DirtyRangeGenerator(
+			Gen generator  //!< Generator that provides the randomness.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) }
+		{
+		}
+
+		//! Starts a new list of ranges.
+		constexpr void BeginRound()
+		{
+			Details::NotifyBeginRound( m_generator );
+			m_ranges.Clear();
+		}
+
+		//! Forwards the start of a step.
+		constexpr void BeginStep(
+			size_t index  //!< Index of the mutation in the table.
+		)
+		{
+			Details::NotifyBeginStep( m_generator, index );
+		}
+
+		//! Forwards the end of a step.
+		constexpr void EndStep()
+		{
+			Details::NotifyEndStep( m_generator );
+		}
+
+		//! Records a written range.
+		constexpr void OnWrite(
+			std::span< const std::byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the buffer.
+			size_t size,  //!< Number of written bytes.
+			bool bResize  //!< Whether the write is part of a shift that changes the size of the value.
+		)
+		{
+			Details::NotifyWrite( m_generator, spanBuffer, sizeOffset, size, bResize );
+			m_ranges.Add( sizeOffset, size, bResize );
+		}
+
+		//! Records the destination of a move as a range written by a shift.
+		constexpr void OnMove(
+			std::span< const std::byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+			size_t size  //!< Number of moved bytes.
+		)
+		{
+			Details::NotifyMove( m_generator, spanBuffer, sizeDestination, sizeSource, size );
+			m_ranges.Add( sizeDestination, size, true );
+		}
+
+		//! Gets the ranges written in the latest round.
+		constexpr const DirtyRanges< Capacity >& GetRanges() const
+		{
+			return m_ranges;
+		}
+	};
+
+	/*!
+	Copies the dirty ranges from one buffer to another.
+
+	Copying from a mutant patches a copy of its seed. Copying from the seed restores the seed.
+	Bytes of a range that are outside of either buffer are not copied.
+	*/
+	inline void CopyDirtyRanges(
+		std::span< std::byte > spanDestination,  //!< Buffer that is patched.
+		std::span< const std::byte > spanSource,  //!< Buffer that the ranges are copied from.
+		std::span< const DirtyRange > spanRanges  //!< Ranges that are copied.
+	)
+	{
+		size_t sizeLimit = std::min( spanDestination.size(), spanSource.size() );
+		for( const DirtyRange& range : spanRanges )
+		{
+			if( range.ui64Offset >= sizeLimit )
+				break;
+			size_t size = std::min< uint64_t >( range.ui64Size, sizeLimit - range.ui64Offset );
+			Details::MoveBytes( spanDestination.data() + range.ui64Offset, spanSource.data() + range.ui64Offset, size );
+		}
+	}
+}
@@ -0,0 +1,194 @@
+/*! \file
+Detection of havoc steps that do not change the value.
+*/
+
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Random bit generator adaptor that makes havoc redraw the steps that do not change the value.
+
+	The bytes written by every step are saved before they are written and compared with the buffer when the step
+	ends. A step is ineffective if it wrote nothing, if every written byte kept its value, or if it restored the
+	single region written by the previous step, as flipping the same bit twice does. Steps that change the size of
+	the value or write more than ArenaSize bytes are assumed to be effective. Mutations must report their writes
+	with Details::NotifyWrite like the built-in mutations do, otherwise they are considered ineffective.
+	*/
+	template< class Gen, size_t ArenaSize = 256, size_t MaxRegions = 4 >
+		requires std::uniform_random_bit_generator< Gen >
+	class EffectiveGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		//! Location of a written region.
+		struct Region
+		{
+			size_t sizeOffset = 0;  //!< Offset of the region from the beginning of the buffer.
+			size_t size = 0;  //!< Size of the region.
+			size_t sizeArena = 0;  //!< Offset of the saved bytes in the arena.
+		};
+
+		//! Bytes written by a step before they were written.
+		struct Snapshot
+		{
+			std::array< byte, ArenaSize > arrayArena;  //!< Saved bytes.
+			std::array< Region, MaxRegions > arrayRegions;  //!< Written regions.
+			size_t sizeRegions = 0;  //!< Number of written regions.
+			size_t sizeUsed = 0;  //!< Number of saved bytes.
+			bool bKnown = true;  //!< Whether every write was saved and the size of the value did not change.
+		};
+
+		using Details::GeneratorAdaptor< Gen >::m_generator;
+
+		//! Snapshots of the current and the previous step.
+		std::array< Snapshot, 2 > m_arraySnapshots {};
+
+		//! Index of the snapshot of the current step.
+		size_t m_sizeCurrent = 0;
+
+		//! Whether the other snapshot belongs to an effective previous step of the round.
+		bool m_bPrevious = false;
+
+		//! Beginning of the buffer passed to the mutations.
+		const byte* m_pBuffer = nullptr;
+
+		//! Number of the latest steps that were ineffective.
+		unsigned int m_uiIneffective = 0;
+
+		//! Number of ineffective steps detected.
+		uint64_t m_ui64Ineffective = 0;
+
+	public:
+
+		//! Creates an adaptor with a default-constructed base generator.
+		constexpr EffectiveGenerator() = default;
+
+		//! Creates an adaptor from a base generator.
+		constexpr explicit EffectiveGenerator(
+			Gen generator  //!< Generator that provides the randomness.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) }
+		{
+		}
+
+		//! Forgets the steps of the previous round.
+		constexpr void BeginRound()
+		{
+			Details::NotifyBeginRound( m_generator );
+			m_bPrevious = false;
+		}
+
+		//! Starts saving the writes of a step.
+		constexpr void BeginStep(
+			size_t index  //!< Index of the mutation in the table.
+		)
+		{
+			Details::NotifyBeginStep( m_generator, index );
+			Snapshot& current = m_arraySnapshots[ m_sizeCurrent ];
+			current.sizeRegions = 0;
+			current.sizeUsed = 0;
+			current.bKnown = true;
+			m_uiIneffective = 0;
+		}
+
+		//! Saves a region before it is written.
+		void OnWrite(
+			std::span< const byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the buffer.
+			size_t size,  //!< Number of written bytes.
+			bool bResize  //!< Whether the write is part of a shift that changes the size of the value.
+		)
+		{
+			Details::NotifyWrite( m_generator, spanBuffer, sizeOffset, size, bResize );
+			Snapshot& current = m_arraySnapshots[ m_sizeCurrent ];
+			m_pBuffer = spanBuffer.data();
+			if( ! current.bKnown )
+				return;
+			if( bResize || current.sizeRegions == MaxRegions || size > ArenaSize - current.sizeUsed )
+			{
+				current.bKnown = false;
+				return;
+			}
+			std::memcpy( current.arrayArena.data() + current.sizeUsed, spanBuffer.data() + sizeOffset, size );
+			current.arrayRegions[ current.sizeRegions++ ] = Region { sizeOffset, size, current.sizeUsed };
+			current.sizeUsed += size;
+		}
+
+		//! Marks the step as effective because it changes the size of the value.
+		void OnMove(
+			std::span< const byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+			size_t size  //!< Number of moved bytes.
+		)
+		{
+			Details::NotifyMove( m_generator, spanBuffer, sizeDestination, sizeSource, size );
+			m_arraySnapshots[ m_sizeCurrent ].bKnown = false;
+		}
+
+		//! Compares the written regions with their saved bytes.
+		void EndStep()
+		{
+			Details::NotifyEndStep( m_generator );
+
+			// Check whether the step kept or restored the written bytes.
+			const Snapshot& current = m_arraySnapshots[ m_sizeCurrent ];
+			const Snapshot& previous = m_arraySnapshots[ m_sizeCurrent ^ 1 ];
+			if( current.bKnown && Unchanged( current ) )
+				m_uiIneffective = 1;
+			else if( current.bKnown && m_bPrevious && previous.bKnown && current.sizeRegions == 1 && previous.sizeRegions == 1 &&
+					current.arrayRegions[ 0 ].sizeOffset == previous.arrayRegions[ 0 ].sizeOffset &&
+					current.arrayRegions[ 0 ].size == previous.arrayRegions[ 0 ].size && Unchanged( previous ) )
+				m_uiIneffective = 2;
+			m_ui64Ineffective += m_uiIneffective;
+
+			// An effective step becomes the previous step. Undone steps leave no previous step.
+			if( m_uiIneffective == 0 )
+			{
+				m_sizeCurrent ^= 1;
+				m_bPrevious = true;
+			}
+			else if( m_uiIneffective == 2 )
+			{
+				m_bPrevious = false;
+			}
+		}
+
+		//! Gets the number of the latest steps that did not change the value.
+		constexpr unsigned int IneffectiveSteps() const
+		{
+			return m_uiIneffective;
+		}
+
+		//! Gets the total number of ineffective steps detected.
+		constexpr uint64_t GetIneffectiveCount() const
+		{
+			return m_ui64Ineffective;
+		}
+
+	private:
+
+		//! Gets whether the buffer still contains the saved bytes of every region of a snapshot.
+		bool Unchanged(
+			const Snapshot& snapshot  //!< Snapshot that is compared.
+		) const
+		{
+			for( size_t i = 0; i < snapshot.sizeRegions; i++ )
+			{
+				const Region& region = snapshot.arrayRegions[ i ];
+				if( std::memcmp( m_pBuffer + region.sizeOffset, snapshot.arrayArena.data() + region.sizeArena, region.size ) != 0 )
+					return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,189 @@
+/*! \file
+Havoc mutations of structured buffers made of several variable-length fields.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Location of a variable-length field in a structured buffer.
+	struct FieldLayout
+	{
+		size_t sizeOffset = 0;  //!< Offset of the field from the beginning of the buffer.
+		size_t sizeCapacity = 0;  //!< Maximum size of the field.
+	};
+
+	namespace Details
+	{
+		//! Checks that the fields are sorted, disjoint and inside the buffer and that their sizes fit.
+		inline bool IsValidLayout(
+			size_t sizeBuffer,  //!< Size of the buffer.
+			std::span< const FieldLayout > spanFields,  //!< Layout of the fields.
+			std::span< const size_t > spanSizes  //!< Current size of each field.
+		)
+		{
+			if( spanFields.size() != spanSizes.size() )
+				return false;
+			size_t sizeEnd = 0;
+			for( size_t i = 0; i < spanFields.size(); i++ )
+			{
+				const FieldLayout& field = spanFields[ i ];
+				if( field.sizeOffset < sizeEnd || field.sizeOffset > sizeBuffer || field.sizeCapacity > sizeBuffer - field.sizeOffset ||
+						spanSizes[ i ] > field.sizeCapacity )
+					return false;
+				sizeEnd = field.sizeOffset + field.sizeCapacity;
+			}
+			return true;
+		}
+
+		//! Concept for a random number generator with hooks that take offsets in the buffer.
+		template< class Gen >
+		concept PositionObserver = WriteObserver< Gen > || MoveObserver< Gen > || OffsetSource< Gen >;
+	}
+
+	/*!
+	Random bit generator adaptor that translates the offsets of the mutations of a field to offsets in its buffer.
+
+	The generator is not owned. Writes and moves are forwarded with offsets from the beginning of the buffer, so
+	undo journals and dirty ranges of the buffer stay valid. Generators that draw offsets cannot be restricted
+	to the field, so the positions in a field are drawn uniformly.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< Gen >
+	class FieldGenerator : public Details::GeneratorAdaptor< Gen& >
+	{
+	private:
+
+		using Details::GeneratorAdaptor< Gen& >::m_generator;
+
+		//! Buffer containing the field.
+		std::span< const byte > m_spanBuffer;
+
+		//! Offset of the field from the beginning of the buffer.
+		size_t m_sizeOffset = 0;
+
+	public:
+
+		//! Creates an adaptor for a field of a buffer.
+		FieldGenerator(
+			Gen& generator,  //!< Generator that receives the translated offsets. Must outlive the adaptor.
+			std::span< const byte > spanBuffer,  //!< Buffer containing the field.
+			size_t sizeOffset  //!< Offset of the field from the beginning of the buffer.
+		) :
+		Details::GeneratorAdaptor< Gen& > { generator },
+		m_spanBuffer { spanBuffer },
+		m_sizeOffset { sizeOffset }
+		{
+		}
+
+		//! Forwards a write with its offset in the buffer.
+		constexpr void OnWrite(
+			std::span< const byte >,  //!< Field passed to the mutation.
+			size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the field.
+			size_t size,  //!< Number of written bytes.
+			bool bResize  //!< Whether the write is part of a shift that changes the size of the value.
+		)
+			requires Details::WriteObserver< Gen >
+		{
+			Details::NotifyWrite( m_generator, m_spanBuffer, m_sizeOffset + sizeOffset, size, bResize );
+		}
+
+		//! Forwards a move with its offsets in the buffer.
+		constexpr void OnMove(
+			std::span< const byte >,  //!< Field passed to the mutation.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the field.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the field.
+			size_t size  //!< Number of moved bytes.
+		)
+			requires Details::MoveObserver< Gen >
+		{
+			Details::NotifyMove( m_generator, m_spanBuffer, m_sizeOffset + sizeDestination, m_sizeOffset + sizeSource, size );
+		}
+
+		//! Draws a uniform offset in the field instead of an offset of the generator, which refers to the buffer.
+		constexpr size_t DrawOffset(
+			size_t sizeMax  //!< Largest possible offset.
+		)
+			requires Details::OffsetSource< Gen >
+		{
+			return Details::RandomInRange< size_t >( 0, sizeMax, m_generator );
+		}
+	};
+
+	//! Generator that HavocFields passes to the engine. Generators with hooks that take offsets are wrapped in a FieldGenerator.
+	template< class Gen >
+	using FieldEngineGenerator = std::conditional_t< Details::PositionObserver< Gen >, FieldGenerator< Gen >, Gen >;
+
+	/*!
+	Applies a round of havoc mutations to a random field of a structured buffer in place.
+
+	Every field is mutated in its own region of the buffer, bounded by its capacity, like a value in a buffer of
+	that size. The sizes are updated with the new size of the mutated field, and the bytes a field no longer covers
+	are zeroed. Generators that observe writes or moves see offsets from the beginning of the buffer, so the engine
+	is invoked with the FieldEngineGenerator of the generator. Returns the index of the mutated field.
+	*/
+	template< class Engine, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+			std::invocable< Engine&, std::span< byte >, size_t, FieldEngineGenerator< std::remove_reference_t< Gen > >& >
+	size_t HavocFields(
+		Engine& engine,  //!< Havoc engine or another function that applies a round of mutations to a value.
+		std::span< byte > spanBuffer,  //!< Buffer containing the fields.
+		std::span< const FieldLayout > spanFields,  //!< Layout of the fields sorted by offset. Must not be empty.
+		std::span< size_t > spanSizes,  //!< Current size of each field.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Select a field and mutate its region.
+		assert( ! spanFields.empty() && Details::IsValidLayout( spanBuffer.size(), spanFields, spanSizes ) );
+		size_t index = Details::RandomInRange< size_t >( 0, spanFields.size() - 1, generator );
+		const FieldLayout& field = spanFields[ index ];
+		std::span< byte > spanField = spanBuffer.subspan( field.sizeOffset, field.sizeCapacity );
+		if constexpr( Details::PositionObserver< std::remove_reference_t< Gen > > )
+		{
+			FieldGenerator< std::remove_reference_t< Gen > > fieldGenerator { generator, spanBuffer, field.sizeOffset };
+			spanSizes[ index ] = engine( spanField, spanSizes[ index ], fieldGenerator ).size();
+		}
+		else
+		{
+			spanSizes[ index ] = engine( spanField, spanSizes[ index ], generator ).size();
+		}
+		return index;
+	}
+
+	//! Applies a round of havoc mutations to a random field of a structured buffer in place with the default mutations.
+	template< unsigned int MaxIterationsPower = 5, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	size_t HavocFields(
+		std::span< byte > spanBuffer,  //!< Buffer containing the fields.
+		std::span< const FieldLayout > spanFields,  //!< Layout of the fields sorted by offset. Must not be empty.
+		std::span< size_t > spanSizes,  //!< Current size of each field.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// The engine and its mutation table are built at compile-time.
+		static constexpr HavocEngine< FieldEngineGenerator< std::remove_reference_t< Gen > >, MaxIterationsPower > engine {};
+		return HavocFields( engine, spanBuffer, spanFields, spanSizes, generator );
+	}
+
+	//! Applies a round of havoc mutations to a random field of a structured buffer of a byte-like type such as char or uint8_t.
+	template< unsigned int MaxIterationsPower = 5, Details::ByteLike T, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	size_t HavocFields(
+		std::span< T > spanBuffer,  //!< Buffer containing the fields.
+		std::span< const FieldLayout > spanFields,  //!< Layout of the fields sorted by offset. Must not be empty.
+		std::span< size_t > spanSizes,  //!< Current size of each field.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		return HavocFields< MaxIterationsPower >( std::as_writable_bytes( spanBuffer ), spanFields, spanSizes, generator );
+	}
+}
@@ -0,0 +1,287 @@
+/*! \file
+Weighted selection of the positions of the mutations from coverage feedback.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/DirtyRanges.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Weights of the blocks of a value that the positions of the mutations are drawn from.
+
+	The weights are kept in a Fenwick tree, so updating a weight and drawing a position both take
+	O( log blocks ) time. Memory is only allocated when the map is constructed.
+	*/
+	class HotRegionMap
+	{
+	private:
+
+		//! Base-2 logarithm of the size of a block.
+		unsigned int m_uiBlockShift = 0;
+
+		//! Weight of every block.
+		std::vector< uint64_t > m_vecWeights;
+
+		//! Fenwick tree of the weights. Node i holds the sum of the weights of blocks ( i - lowbit( i ), i ].
+		std::vector< uint64_t > m_vecTree;
+
+	public:
+
+		//! Creates a map of a value where every block has the same weight.
+		explicit HotRegionMap(
+			size_t sizeValue,  //!< Size of the value.
+			unsigned int uiBlockShift = 6,  //!< Base-2 logarithm of the size of a block.
+			uint64_t ui64InitialWeight = 1  //!< Initial weight of every block.
+		) :
+		m_uiBlockShift { uiBlockShift },
+		m_vecWeights( std::max< size_t >( ( sizeValue + ( size_t { 1 } << uiBlockShift ) - 1 ) >> uiBlockShift, 1 ) ),
+		m_vecTree( m_vecWeights.size() + 1 )
+		{
+			Fill( ui64InitialWeight );
+		}
+
+		//! Gets the number of blocks.
+		size_t Blocks() const
+		{
+			return m_vecWeights.size();
+		}
+
+		//! Gets the size of a block.
+		size_t BlockSize() const
+		{
+			return size_t { 1 } << m_uiBlockShift;
+		}
+
+		//! Gets the weight of a block.
+		uint64_t GetWeight(
+			size_t sizeBlock  //!< Index of the block.
+		) const
+		{
+			assert( sizeBlock < Blocks() );
+			return m_vecWeights[ sizeBlock ];
+		}
+
+		//! Replaces the weight of a block.
+		void SetWeight(
+			size_t sizeBlock,  //!< Index of the block.
+			uint64_t ui64Weight  //!< New weight of the block.
+		)
+		{
+			// Propagate the difference to every node that covers the block.
+			assert( sizeBlock < Blocks() );
+			uint64_t ui64Delta = ui64Weight - m_vecWeights[ sizeBlock ];
+			m_vecWeights[ sizeBlock ] = ui64Weight;
+			for( size_t i = sizeBlock + 1; i < m_vecTree.size(); i += i & ( 0 - i ) )
+				m_vecTree[ i ] += ui64Delta;
+		}
+
+		//! Adds to the weight of every block that overlaps a range of bytes. Bytes past the end of the map are ignored.
+		void Reward(
+			size_t sizeOffset,  //!< Offset of the first byte.
+			size_t size,  //!< Number of bytes.
+			uint64_t ui64Amount  //!< Weight added to every block.
+		)
+		{
+			if( size == 0 )
+				return;
+			size_t sizeFirst = sizeOffset >> m_uiBlockShift;
+			size_t sizeLast = std::min( ( sizeOffset + size - 1 ) >> m_uiBlockShift, Blocks() - 1 );
+			for( size_t i = sizeFirst; i <= sizeLast; i++ )
+				SetWeight( i, m_vecWeights[ i ] + ui64Amount );
+		}
+
+		//! Replaces the weight of every block.
+		void Fill(
+			uint64_t ui64Weight  //!< New weight of every block.
+		)
+		{
+			// Build the tree in linear time by pushing every node to its parent.
+			std::ranges::fill( m_vecWeights, ui64Weight );
+			std::ranges::fill( m_vecTree, ui64Weight );
+			m_vecTree[ 0 ] = 0;
+			for( size_t i = 1; i < m_vecTree.size(); i++ )
+			{
+				size_t sizeParent = i + ( i & ( 0 - i ) );
+				if( sizeParent < m_vecTree.size() )
+					m_vecTree[ sizeParent ] += m_vecTree[ i ];
+			}
+		}
+
+		//! Gets the sum of the weights of the first blocks.
+		uint64_t Prefix(
+			size_t sizeBlocks  //!< Number of blocks.
+		) const
+		{
+			assert( sizeBlocks <= Blocks() );
+			uint64_t ui64Sum = 0;
+			for( size_t i = sizeBlocks; i > 0; i -= i & ( 0 - i ) )
+				ui64Sum += m_vecTree[ i ];
+			return ui64Sum;
+		}
+
+		/*!
+		Draws an offset in range [0, sizeMax] with the probability of its block proportional to its weight.
+
+		The offset is uniform within its block. Offsets past the end of the map belong to the last block.
+		Falls back to a uniform offset if every eligible block has zero weight.
+		*/
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		size_t Draw(
+			size_t sizeMax,  //!< Largest possible offset.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+		{
+			// Draw a block among the blocks that contain eligible offsets.
+			size_t sizeBlocks = std::min( ( sizeMax >> m_uiBlockShift ) + 1, Blocks() );
+			uint64_t ui64Total = Prefix( sizeBlocks );
+			if( ui64Total == 0 )
+				return Details::RandomInRange< size_t >( 0, sizeMax, generator );
+			size_t sizeBlock = Find( Details::RandomInRange< uint64_t >( 0, ui64Total - 1, generator ) );
+			assert( sizeBlock < sizeBlocks );
+
+			// Draw an offset within the block.
+			size_t sizeBegin = sizeBlock << m_uiBlockShift;
+			size_t sizeEnd = sizeBlock + 1 == sizeBlocks ? sizeMax : sizeBegin + BlockSize() - 1;
+			return Details::RandomInRange< size_t >( sizeBegin, sizeEnd, generator );
+		}
+
+	private:
+
+		//! Finds the block that contains a point of the cumulative weights.
+		size_t Find(
+			uint64_t ui64Point  //!< Point that is smaller than the sum of all weights.
+		) const
+		{
+			// Descend the tree from the largest power of two.
+			size_t sizeIndex = 0;
+			for( size_t sizeStep = std::bit_floor( Blocks() ); sizeStep > 0; sizeStep >>= 1 )
+			{
+				size_t sizeNext = sizeIndex + sizeStep;
+				if( sizeNext <= Blocks() && m_vecTree[ sizeNext ] <= ui64Point )
+				{
+					ui64Point -= m_vecTree[ sizeNext ];
+					sizeIndex = sizeNext;
+				}
+			}
+			return sizeIndex;
+		}
+	};
+
+	/*!
+	Random bit generator adaptor that draws the positions of the mutations from a hot-region map.
+
+	The ranges written by the latest round are collected, so Reward can credit them after the mutant found
+	new coverage. Offsets are relative to the buffer passed to havoc, so the map should describe the seed.
+	The map is not owned, so every worker can share one map if the updates are synchronized.
+	*/
+	template< class Gen, size_t Capacity = 16 >
+		requires std::uniform_random_bit_generator< Gen >
+	class HotRegionGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		using Details::GeneratorAdaptor< Gen >::m_generator;
+
+		//! Weights the positions are drawn from.
+		HotRegionMap* m_pMap = nullptr;
+
+		//! Ranges written in the latest round.
+		DirtyRanges< Capacity > m_ranges;
+
+	public:
+
+		//! Creates a generator from a base generator and a map.
+		HotRegionGenerator(
+			Gen generator,  //!< Generator that provides the randomness.
+			HotRegionMap& map  //!< Weights the positions are drawn from. Must outlive the generator.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) },
+		m_pMap { &map }
+		{
+		}
+
+		//! Draws the offset of a position from the map.
+		size_t DrawOffset(
+			size_t sizeMax  //!< Largest possible offset.
+		)
+		{
+			return m_pMap->Draw( sizeMax, m_generator );
+		}
+
+		//! Starts a new list of ranges.
+		constexpr void BeginRound()
+		{
+			Details::NotifyBeginRound( m_generator );
+			m_ranges.Clear();
+		}
+
+		//! Forwards the start of a step.
+		constexpr void BeginStep(
+			size_t index  //!< Index of the mutation in the table.
+		)
+		{
+			Details::NotifyBeginStep( m_generator, index );
+		}
+
+		//! Forwards the end of a step.
+		constexpr void EndStep()
+		{
+			Details::NotifyEndStep( m_generator );
+		}
+
+		//! Records a written range.
+		constexpr void OnWrite(
+			std::span< const std::byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the buffer.
+			size_t size,  //!< Number of written bytes.
+			bool bResize  //!< Whether the write is part of a shift that changes the size of the value.
+		)
+		{
+			Details::NotifyWrite( m_generator, spanBuffer, sizeOffset, size, bResize );
+			m_ranges.Add( sizeOffset, size, bResize );
+		}
+
+		//! Forwards moves without recording them. Only the bytes written at the positions of the mutations are credited.
+		constexpr void OnMove(
+			std::span< const std::byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+			size_t size  //!< Number of moved bytes.
+		)
+		{
+			Details::NotifyMove( m_generator, spanBuffer, sizeDestination, sizeSource, size );
+		}
+
+		//! Adds to the weight of every block written by the latest round.
+		void Reward(
+			uint64_t ui64Amount  //!< Weight added to every block.
+		)
+		{
+			for( const DirtyRange& range : m_ranges.Get() )
+				m_pMap->Reward( range.ui64Offset, range.ui64Size, ui64Amount );
+		}
+
+		//! Gets the ranges written in the latest round.
+		constexpr const DirtyRanges< Capacity >& GetRanges() const
+		{
+			return m_ranges;
+		}
+
+		//! Gets the map.
+		constexpr HotRegionMap& GetMap() const
+		{
+			return *m_pMap;
+		}
+	};
+}
@@ -0,0 +1,244 @@
+/*! \file
+Instrumentation policies that observe the hot path of havoc mutations.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#elif defined( _M_X64 ) || defined( _M_IX86 )
+#include <intrin.h>
+#endif
+
+#include "AFLMutationFunctions/Details.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Concept for an object that observes a round of havoc mutations.
+
+	OnRound is called with the number of planned iterations, OnSizeState with the size state of every iteration
+	and BeginMutation and EndMutation around every applied mutation.
+	*/
+	template< class I >
+	concept MutationInstrumentation = requires( I& instrumentation, Details::SizeState state, uint64_t ui64Start ) {
+		instrumentation.OnRound( 0u );
+		instrumentation.OnSizeState( state );
+		{
+			instrumentation.BeginMutation()
+		} -> std::convertible_to< uint64_t >;
+		instrumentation.EndMutation( size_t {}, ui64Start, size_t {}, size_t {} );
+	};
+
+	//! Instrumentation that records nothing and has no cost.
+	struct NoInstrumentation
+	{
+		//! Ignores the start of a round.
+		constexpr void OnRound(
+			unsigned int  //!< Number of planned iterations.
+		) const
+		{
+		}
+
+		//! Ignores the size state of an iteration.
+		constexpr void OnSizeState(
+			Details::SizeState  //!< Size state of the value.
+		) const
+		{
+		}
+
+		//! Ignores the start of a mutation.
+		constexpr uint64_t BeginMutation() const
+		{
+			return 0;
+		}
+
+		//! Ignores the end of a mutation.
+		constexpr void EndMutation(
+			size_t,  //!< Index of the mutation in the table.
+			uint64_t,  //!< Value returned by BeginMutation.
+			size_t,  //!< Size of the value before the mutation.
+			size_t  //!< Size of the value after the mutation.
+		) const
+		{
+		}
+	};
+
+	namespace Details
+	{
+		//! Reads the time stamp counter, or a monotonic clock in nanoseconds where the counter is not available.
+		inline uint64_t ReadCycleCounter()
+		{
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+			return __rdtsc();
+#else
+			return static_cast< uint64_t >( std::chrono::duration_cast< std::chrono::nanoseconds >(
+				std::chrono::steady_clock::now().time_since_epoch() ).count() );
+#endif
+		}
+	}
+
+	//! Number of buckets in a cycle histogram. Bucket i counts durations with a bit width of i.
+	inline constexpr size_t CycleHistogramBuckets = 32;
+
+	//! Counters of a single mutation collected by CountingInstrumentation.
+	struct MutationCounters
+	{
+		uint64_t ui64Selections = 0;  //!< Number of times the mutation was applied.
+		uint64_t ui64BytesInserted = 0;  //!< Total number of bytes the mutation added to values.
+		uint64_t ui64BytesRemoved = 0;  //!< Total number of bytes the mutation removed from values.
+		uint64_t ui64Cycles = 0;  //!< Total number of cycles spent in the mutation.
+		std::array< uint64_t, CycleHistogramBuckets > arrayCycleHistogram {};  //!< Durations bucketed by bit width.
+
+		//! Adds the counters of another mutation.
+		constexpr MutationCounters& operator+=(
+			const MutationCounters& other  //!< Counters that are added.
+		)
+		{
+			ui64Selections += other.ui64Selections;
+			ui64BytesInserted += other.ui64BytesInserted;
+			ui64BytesRemoved += other.ui64BytesRemoved;
+			ui64Cycles += other.ui64Cycles;
+			for( size_t i = 0; i < CycleHistogramBuckets; i++ )
+				arrayCycleHistogram[ i ] += other.arrayCycleHistogram[ i ];
+			return *this;
+		}
+	};
+
+	/*!
+	Snapshot of the counters collected by CountingInstrumentation.
+
+	Snapshots of instrumentations owned by different threads can be added together.
+	*/
+	template< size_t Capacity = 32 >
+	struct InstrumentationSnapshot
+	{
+		uint64_t ui64Rounds = 0;  //!< Number of rounds.
+		uint64_t ui64PlannedIterations = 0;  //!< Number of iterations drawn for the rounds.
+		uint64_t ui64MustIncrease = 0;  //!< Iterations where only increasing mutations were suitable.
+		uint64_t ui64CanIncrease = 0;  //!< Iterations where every mutation was suitable.
+		uint64_t ui64CannotIncrease = 0;  //!< Iterations where increasing mutations were not suitable.
+		std::array< MutationCounters, Capacity > arrayMutations {};  //!< Counters of each mutation in the table.
+
+		//! Gets the number of applied mutations.
+		constexpr uint64_t GetAppliedIterations() const
+		{
+			uint64_t ui64Applied = 0;
+			for( const MutationCounters& counters : arrayMutations )
+				ui64Applied += counters.ui64Selections;
+			return ui64Applied;
+		}
+
+		//! Adds the counters of another snapshot.
+		constexpr InstrumentationSnapshot& operator+=(
+			const InstrumentationSnapshot& other  //!< Snapshot that is added.
+		)
+		{
+			ui64Rounds += other.ui64Rounds;
+			ui64PlannedIterations += other.ui64PlannedIterations;
+			ui64MustIncrease += other.ui64MustIncrease;
+			ui64CanIncrease += other.ui64CanIncrease;
+			ui64CannotIncrease += other.ui64CannotIncrease;
+			for( size_t i = 0; i < Capacity; i++ )
+				arrayMutations[ i ] += other.arrayMutations[ i ];
+			return *this;
+		}
+	};
+
+	/*!
+	Instrumentation that counts rounds, size states and applied mutations.
+
+	The counters are plain members, so an engine and its instrumentation are meant to be owned by a single thread.
+	Cycle histograms are collected when MeasureCycles is set.
+	*/
+	template< bool MeasureCycles = false, size_t Capacity = 32 >
+	class CountingInstrumentation
+	{
+	private:
+
+		//! Counters collected so far.
+		InstrumentationSnapshot< Capacity > m_snapshot;
+
+	public:
+
+		//! Counts a round.
+		constexpr void OnRound(
+			unsigned int uiIterations  //!< Number of planned iterations.
+		)
+		{
+			m_snapshot.ui64Rounds++;
+			m_snapshot.ui64PlannedIterations += uiIterations;
+		}
+
+		//! Counts the size state of an iteration.
+		constexpr void OnSizeState(
+			Details::SizeState state  //!< Size state of the value.
+		)
+		{
+			switch( state )
+			{
+			case Details::SizeState::MustIncrease:
+				m_snapshot.ui64MustIncrease++;
+				break;
+			case Details::SizeState::CanIncrease:
+				m_snapshot.ui64CanIncrease++;
+				break;
+			case Details::SizeState::CannotIncrease:
+				m_snapshot.ui64CannotIncrease++;
+				break;
+			}
+		}
+
+		//! Reads the cycle counter if cycles are measured.
+		uint64_t BeginMutation() const
+		{
+			if constexpr( MeasureCycles )
+				return Details::ReadCycleCounter();
+			else
+				return 0;
+		}
+
+		//! Counts an applied mutation.
+		void EndMutation(
+			size_t index,  //!< Index of the mutation in the table.
+			[[maybe_unused]] uint64_t ui64Start,  //!< Value returned by BeginMutation.
+			size_t sizeBefore,  //!< Size of the value before the mutation.
+			size_t sizeAfter  //!< Size of the value after the mutation.
+		)
+		{
+			MutationCounters& counters = m_snapshot.arrayMutations[ index ];
+			counters.ui64Selections++;
+			if( sizeAfter > sizeBefore )
+				counters.ui64BytesInserted += sizeAfter - sizeBefore;
+			else
+				counters.ui64BytesRemoved += sizeBefore - sizeAfter;
+
+			// Bucket the duration by its bit width.
+			if constexpr( MeasureCycles )
+			{
+				uint64_t ui64Cycles = Details::ReadCycleCounter() - ui64Start;
+				counters.ui64Cycles += ui64Cycles;
+				counters.arrayCycleHistogram[ std::min< size_t >( std::bit_width( ui64Cycles ), CycleHistogramBuckets - 1 ) ]++;
+			}
+		}
+
+		//! Gets a copy of the counters collected so far.
+		constexpr InstrumentationSnapshot< Capacity > GetSnapshot() const
+		{
+			return m_snapshot;
+		}
+
+		//! Clears the counters.
+		constexpr void Reset()
+		{
+			m_snapshot = {};
+		}
+	};
+}
@@ -0,0 +1,78 @@
+/*! \file
+Compile-time tables of interesting integers extended with target-specific values.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "AFLMutationFunctions/Details.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Sorted table of interesting integers bucketed by width.
+
+	The integers that fit in a width are a prefix of the table, so selecting an integer of a width is a lookup of
+	the width's count and an index into the table.
+	*/
+	template< size_t Size >
+	struct InterestingTable
+	{
+		std::array< uint64_t, Size > arrayValues {};  //!< Interesting integers and their endian-swapped versions in ascending order.
+		std::array< size_t, 9 > arrayCountsByWidth {};  //!< Number of integers that fit in each width in bytes from 0 to 8.
+
+		//! Gets the integers that fit in a width.
+		constexpr std::span< const uint64_t > GetFitting(
+			size_t sizeWidth  //!< Width in bytes from 0 to 8.
+		) const
+		{
+			assert( sizeWidth < arrayCountsByWidth.size() );
+			return std::span { arrayValues }.first( arrayCountsByWidth[ sizeWidth ] );
+		}
+	};
+
+	namespace Details
+	{
+		//! Gets the default interesting integers and the extra integers with their endian-swapped versions.
+		template< auto... arrayExtras >
+		constexpr std::vector< uint64_t > GetInterestingWith()
+		{
+			// Add the extra integers in both endians.
+			std::vector< uint64_t > vecInterestingInts = GetInteresting();
+			( AddValuesAndTheirSwappedEndians( arrayExtras, vecInterestingInts ), ... );
+
+			// Remove duplicates.
+			std::ranges::sort( vecInterestingInts );
+			auto removed = std::ranges::unique( vecInterestingInts );
+			vecInterestingInts.erase( removed.begin(), removed.end() );
+			return vecInterestingInts;
+		}
+	}
+
+	/*!
+	Builds a table of the default interesting integers and extra target-specific integers at compile-time.
+
+	Every extra list is an array of integers whose type sets the width of the integers, for example
+	std::array< uint16_t, 2 > { 0x4d5a, 1500 } for 16-bit magic numbers and length limits. Like the default
+	integers, every extra integer is also added with its bytes swapped.
+	*/
+	template< auto... arrayExtras >
+	consteval auto MakeInterestingTable()
+	{
+		// Get the size of the table at compile-time to reserve a correctly sized array.
+		constexpr size_t size = Details::GetInterestingWith< arrayExtras... >().size();
+		InterestingTable< size > table;
+		std::ranges::copy( Details::GetInterestingWith< arrayExtras... >(), table.arrayValues.begin() );
+		table.arrayCountsByWidth = Details::CountByWidth( table.arrayValues );
+		return table;
+	}
+
+	//! Table of the default interesting integers.
+	inline constexpr auto DefaultInterestingTable = MakeInterestingTable<>();
+}
@@ -0,0 +1,467 @@
+/*! \file
+Multi-threaded havoc mutation with per-thread generators and work stealing.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Batch.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Size of a cache line. Data written by different threads is kept on different cache lines.
+	inline constexpr size_t CacheLineSize = 64;
+
+	namespace Details
+	{
+		//! Concept for a generator that can jump ahead to a non-overlapping stream.
+		template< class Gen >
+		concept Jumpable = std::uniform_random_bit_generator< Gen > && requires( Gen& generator ) {
+			generator.Jump();
+		};
+
+		/*!
+		Fixed-capacity Chase-Lev work-stealing deque.
+
+		The owner pushes and pops at the bottom. Other threads steal from the top.
+		The capacity is rounded up to a power of two and never grows.
+		*/
+		template< class T >
+			requires std::is_trivially_copyable_v< T >
+		class WorkStealingDeque
+		{
+		private:
+
+			//! Index of the next item that is stolen.
+			alignas( CacheLineSize ) std::atomic< int64_t > m_i64Top = 0;
+
+			//! Index after the item the owner pops next.
+			alignas( CacheLineSize ) std::atomic< int64_t > m_i64Bottom = 0;
+
+			//! Mask that maps indices to the item storage.
+			int64_t m_i64Mask = 0;
+
+			//! Storage of the items.
+			std::unique_ptr< std::atomic< T >[] > m_pItems;
+
+		public:
+
+			//! Allocates a deque.
+			explicit WorkStealingDeque(
+				size_t sizeCapacity  //!< Minimum number of items the deque can hold.
+			) :
+			m_i64Mask { static_cast< int64_t >( std::bit_ceil( std::max< size_t >( sizeCapacity, 1 ) ) ) - 1 },
+			m_pItems { std::make_unique< std::atomic< T >[] >( static_cast< size_t >( m_i64Mask + 1 ) ) }
+			{
+			}
+
+			//! Gets the number of items the deque can hold.
+			size_t Capacity() const
+			{
+				return static_cast< size_t >( m_i64Mask + 1 );
+			}
+
+			//! Pushes an item at the bottom. Only the owner may push. Returns false if the deque is full.
+			bool Push(
+				T item  //!< Item that is pushed.
+			)
+			{
+				int64_t i64Bottom = m_i64Bottom.load( std::memory_order_relaxed );
+				int64_t i64Top = m_i64Top.load( std::memory_order_acquire );
+				if( i64Bottom - i64Top > m_i64Mask )
+					return false;
+
+				m_pItems[ i64Bottom & m_i64Mask ].store( item, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_release );
+				m_i64Bottom.store( i64Bottom + 1, std::memory_order_relaxed );
+				return true;
+			}
+
+			//! Pops an item from the bottom. Only the owner may pop.
+			std::optional< T > Pop()
+			{
+				// Reserve the bottom item before checking whether a thief took it.
+				int64_t i64Bottom = m_i64Bottom.load( std::memory_order_relaxed ) - 1;
+				m_i64Bottom.store( i64Bottom, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				int64_t i64Top = m_i64Top.load( std::memory_order_relaxed );
+				if( i64Top > i64Bottom )
+				{
+					m_i64Bottom.store( i64Bottom + 1, std::memory_order_relaxed );
+					return std::nullopt;
+				}
+
+				// The last item is raced for with the thieves.
+				T item = m_pItems[ i64Bottom & m_i64Mask ].load( std::memory_order_relaxed );
+				if( i64Top == i64Bottom )
+				{
+					bool bWon = m_i64Top.compare_exchange_strong(
+						i64Top, i64Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+					m_i64Bottom.store( i64Bottom + 1, std::memory_order_relaxed );
+					if( ! bWon )
+						return std::nullopt;
+				}
+				return item;
+			}
+
+			//! Steals an item from the top. Any thread may steal. Fails if the deque is empty or another thread won the item.
+			std::optional< T > Steal()
+			{
+				int64_t i64Top = m_i64Top.load( std::memory_order_acquire );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				int64_t i64Bottom = m_i64Bottom.load( std::memory_order_acquire );
+				if( i64Top >= i64Bottom )
+					return std::nullopt;
+
+				T item = m_pItems[ i64Top & m_i64Mask ].load( std::memory_order_relaxed );
+				if( ! m_i64Top.compare_exchange_strong(
+						i64Top, i64Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+					return std::nullopt;
+				return item;
+			}
+		};
+	}
+
+	//! Mutant read from a MutantRing.
+	struct RingMutant
+	{
+		std::span< const std::byte > spanData;  //!< Contents of the mutant.
+		size_t sizeEntry = 0;  //!< Index of the corpus entry the mutant was created from.
+	};
+
+	/*!
+	Lock-free single-producer single-consumer ring of mutants.
+
+	Every slot holds at most a fixed number of bytes. The producer mutates directly in a reserved slot,
+	and the consumer reads a published slot in place until it releases it.
+	*/
+	class MutantRing
+	{
+	private:
+
+		//! Deletes memory allocated with BatchAlignment.
+		struct AlignedDelete
+		{
+			void operator()( std::byte* p ) const
+			{
+				::operator delete[]( p, std::align_val_t { BatchAlignment } );
+			}
+		};
+
+		//! Size and corpus entry of the mutant in a slot.
+		struct SlotInfo
+		{
+			size_t sizeMutant = 0;  //!< Size of the mutant.
+			size_t sizeEntry = 0;  //!< Index of the corpus entry the mutant was created from.
+		};
+
+		//! Number of slots the consumer has released. Written by the consumer.
+		alignas( CacheLineSize ) std::atomic< uint64_t > m_ui64Head = 0;
+
+		//! Producer's copy of m_ui64Head that is refreshed when the ring looks full.
+		alignas( CacheLineSize ) uint64_t m_ui64CachedHead = 0;
+
+		//! Number of slots the producer has published. Written by the producer.
+		alignas( CacheLineSize ) std::atomic< uint64_t > m_ui64Tail = 0;
+
+		//! Consumer's copy of m_ui64Tail that is refreshed when the ring looks empty.
+		alignas( CacheLineSize ) uint64_t m_ui64CachedTail = 0;
+
+		//! Maximum size of a single mutant.
+		size_t m_sizeCapacity = 0;
+
+		//! Distance between the beginnings of consecutive slots.
+		size_t m_sizeStride = 0;
+
+		//! Mask that maps sequence numbers to slots.
+		uint64_t m_ui64Mask = 0;
+
+		//! Storage of the mutants.
+		std::unique_ptr< std::byte[], AlignedDelete > m_pArena;
+
+		//! Sizes and corpus entries of the mutants in the slots.
+		std::unique_ptr< SlotInfo[] > m_pSlots;
+
+	public:
+
+		//! Allocates a ring.
+		MutantRing(
+			size_t sizeCapacity,  //!< Maximum size of a single mutant.
+			size_t sizeSlots  //!< Minimum number of slots. Rounded up to a power of two.
+		) :
+		m_sizeCapacity { sizeCapacity },
+		m_sizeStride { GetBatchStride( sizeCapacity ) },
+		m_ui64Mask { std::bit_ceil( std::max< uint64_t >( sizeSlots, 1 ) ) - 1 },
+		m_pArena { static_cast< std::byte* >( ::operator new[](
+				std::max< size_t >( m_sizeStride * ( m_ui64Mask + 1 ), 1 ), std::align_val_t { BatchAlignment } ) ) },
+		m_pSlots { std::make_unique< SlotInfo[] >( m_ui64Mask + 1 ) }
+		{
+			assert( sizeCapacity > 0 );
+		}
+
+		//! Gets the number of slots.
+		size_t Slots() const
+		{
+			return m_ui64Mask + 1;
+		}
+
+		//! Reserves the next slot for writing. Returns an empty span if the ring is full. Producer only.
+		std::span< std::byte > Reserve()
+		{
+			uint64_t ui64Tail = m_ui64Tail.load( std::memory_order_relaxed );
+			if( ui64Tail - m_ui64CachedHead > m_ui64Mask )
+			{
+				m_ui64CachedHead = m_ui64Head.load( std::memory_order_acquire );
+				if( ui64Tail - m_ui64CachedHead > m_ui64Mask )
+					return {};
+			}
+			return { m_pArena.get() + ( ui64Tail & m_ui64Mask ) * m_sizeStride, m_sizeCapacity };
+		}
+
+		//! Publishes the slot returned by Reserve. Producer only.
+		void Publish(
+			size_t sizeMutant,  //!< Size of the mutant written to the slot.
+			size_t sizeEntry  //!< Index of the corpus entry the mutant was created from.
+		)
+		{
+			assert( sizeMutant <= m_sizeCapacity );
+			uint64_t ui64Tail = m_ui64Tail.load( std::memory_order_relaxed );
+			m_pSlots[ ui64Tail & m_ui64Mask ] = SlotInfo { sizeMutant, sizeEntry };
+			m_ui64Tail.store( ui64Tail + 1, std::memory_order_release );
+		}
+
+		//! Gets the oldest published mutant without releasing it. Consumer only.
+		std::optional< RingMutant > Peek()
+		{
+			uint64_t ui64Head = m_ui64Head.load( std::memory_order_relaxed );
+			if( ui64Head == m_ui64CachedTail )
+			{
+				m_ui64CachedTail = m_ui64Tail.load( std::memory_order_acquire );
+				if( ui64Head == m_ui64CachedTail )
+					return std::nullopt;
+			}
+
+			const SlotInfo& slot = m_pSlots[ ui64Head & m_ui64Mask ];
+			return RingMutant { { m_pArena.get() + ( ui64Head & m_ui64Mask ) * m_sizeStride, slot.sizeMutant }, slot.sizeEntry };
+		}
+
+		//! Releases the mutant returned by Peek so that its slot can be reused. Consumer only.
+		void Release()
+		{
+			uint64_t ui64Head = m_ui64Head.load( std::memory_order_relaxed );
+			assert( ui64Head != m_ui64Tail.load( std::memory_order_relaxed ) );
+			m_ui64Head.store( ui64Head + 1, std::memory_order_release );
+		}
+	};
+
+	/*!
+	Pool of worker threads that continuously produce havoc mutants of a corpus.
+
+	Every worker owns a generator, an engine, a work-stealing deque of corpus entries and a ring of mutants.
+	Worker i uses the generator seeded with the seed and jumped i times, so the stream of every worker is
+	reproducible. Which worker mutates which entry depends on stealing and is not.
+	When a worker runs out of work and cannot steal any, it queues its share of the corpus again.
+	Every ring must be drained by a single consumer. The corpus entries must outlive the pool.
+	*/
+	template< class Gen = Xoshiro256StarStar, class Engine = HavocEngine< Gen > >
+		requires Details::Jumpable< Gen > && HavocMutator< Engine, Gen >
+	class ParallelHavoc
+	{
+	private:
+
+		//! State owned by a single worker thread.
+		struct alignas( CacheLineSize ) Worker
+		{
+			Gen generator;  //!< Generator used only by this worker.
+			Engine engine;  //!< Engine used only by this worker.
+			Details::WorkStealingDeque< size_t > deque;  //!< Corpus entries queued for this worker.
+			MutantRing ring;  //!< Mutants produced by this worker.
+			std::jthread thread;  //!< Thread running the worker. Started after every worker is constructed.
+
+			//! Creates the state of a worker.
+			Worker(
+				const Gen& generatorWorker,  //!< Generator of the worker.
+				const Engine& engineWorker,  //!< Engine of the worker.
+				size_t sizeShare,  //!< Number of corpus entries assigned to the worker.
+				size_t sizeCapacity,  //!< Maximum size of a single mutant.
+				size_t sizeRingSlots  //!< Minimum number of mutants the ring can hold.
+			) :
+			generator { generatorWorker },
+			engine { engineWorker },
+			deque { sizeShare },
+			ring { sizeCapacity, sizeRingSlots }
+			{
+			}
+		};
+
+		//! Entries of the corpus.
+		std::vector< std::span< const std::byte > > m_vecCorpus;
+
+		//! Number of mutants produced from an entry before the next entry is taken.
+		size_t m_sizeMutantsPerEntry = 0;
+
+		//! Number of workers.
+		size_t m_sizeWorkers = 0;
+
+		//! State of the workers. Every worker is a separate allocation aligned to a cache line.
+		std::vector< std::unique_ptr< Worker > > m_vecWorkers;
+
+	public:
+
+		//! Creates the workers and starts their threads.
+		ParallelHavoc(
+			std::span< const std::span< const std::byte > > spanCorpus,  //!< Entries that are mutated.
+			size_t sizeCapacity,  //!< Maximum size of a single mutant.
+			size_t sizeWorkers,  //!< Number of worker threads.
+			uint64_t ui64Seed,  //!< Seed of the first worker's generator.
+			size_t sizeRingSlots = 256,  //!< Minimum number of mutants every ring can hold.
+			size_t sizeMutantsPerEntry = 16,  //!< Number of mutants produced from an entry before the next entry is taken.
+			const Engine& engine = Engine {}  //!< Engine that is copied to every worker.
+		) :
+		m_vecCorpus( spanCorpus.begin(), spanCorpus.end() ),
+		m_sizeMutantsPerEntry { std::max< size_t >( sizeMutantsPerEntry, 1 ) },
+		m_sizeWorkers { sizeWorkers }
+		{
+			// Give every worker its own stream and its share of the corpus.
+			Gen generator { ui64Seed };
+			size_t sizeShare = ( m_vecCorpus.size() + sizeWorkers - 1 ) / std::max< size_t >( sizeWorkers, 1 );
+			for( size_t i = 0; i < sizeWorkers; i++ )
+			{
+				m_vecWorkers.push_back( std::make_unique< Worker >( generator, engine, sizeShare, sizeCapacity, sizeRingSlots ) );
+				QueueShare( i );
+				generator.Jump();
+			}
+
+			// Start the threads once every worker can be stolen from.
+			for( size_t i = 0; i < sizeWorkers; i++ )
+				m_vecWorkers[ i ]->thread = std::jthread { [ this, i ]( std::stop_token token ) { Run( i, token ); } };
+		}
+
+		ParallelHavoc( const ParallelHavoc& ) = delete;
+		ParallelHavoc& operator=( const ParallelHavoc& ) = delete;
+
+		//! Stops and joins every worker before any of their state is destroyed.
+		~ParallelHavoc()
+		{
+			Stop();
+		}
+
+		//! Gets the number of workers.
+		size_t GetWorkerCount() const
+		{
+			return m_sizeWorkers;
+		}
+
+		//! Gets the ring of mutants produced by a worker.
+		MutantRing& GetRing(
+			size_t sizeWorker  //!< Index of the worker.
+		)
+		{
+			assert( sizeWorker < m_sizeWorkers );
+			return m_vecWorkers[ sizeWorker ]->ring;
+		}
+
+		//! Stops and joins every worker. Mutants already in the rings can still be read.
+		void Stop()
+		{
+			for( size_t i = 0; i < m_sizeWorkers; i++ )
+				m_vecWorkers[ i ]->thread.request_stop();
+			for( size_t i = 0; i < m_sizeWorkers; i++ )
+			{
+				if( m_vecWorkers[ i ]->thread.joinable() )
+					m_vecWorkers[ i ]->thread.join();
+			}
+		}
+
+	private:
+
+		//! Queues the entries assigned to a worker. Only the worker itself or the constructor may call this.
+		void QueueShare(
+			size_t sizeWorker  //!< Index of the worker.
+		)
+		{
+			for( size_t i = sizeWorker; i < m_vecCorpus.size(); i += m_sizeWorkers )
+			{
+				[[maybe_unused]] bool bPushed = m_vecWorkers[ sizeWorker ]->deque.Push( i );
+				assert( bPushed );
+			}
+		}
+
+		//! Takes the next entry from the worker's own deque or steals one from another worker.
+		std::optional< size_t > Take(
+			size_t sizeWorker  //!< Index of the worker.
+		)
+		{
+			Worker& worker = *m_vecWorkers[ sizeWorker ];
+			if( std::optional< size_t > entry = worker.deque.Pop() )
+				return entry;
+
+			// Try the other workers starting from a random victim.
+			size_t sizeFirst = Details::RandomInRange< size_t >( 0, m_sizeWorkers - 1, worker.generator );
+			for( size_t i = 0; i < m_sizeWorkers; i++ )
+			{
+				size_t sizeVictim = ( sizeFirst + i ) % m_sizeWorkers;
+				if( sizeVictim == sizeWorker )
+					continue;
+				if( std::optional< size_t > entry = m_vecWorkers[ sizeVictim ]->deque.Steal() )
+					return entry;
+			}
+
+			// Start another pass over the worker's share.
+			QueueShare( sizeWorker );
+			return worker.deque.Pop();
+		}
+
+		//! Produces mutants until the worker is stopped.
+		void Run(
+			size_t sizeWorker,  //!< Index of the worker.
+			std::stop_token token  //!< Token that requests the worker to stop.
+		)
+		{
+			Worker& worker = *m_vecWorkers[ sizeWorker ];
+			while( ! token.stop_requested() )
+			{
+				// Workers without a share idle until there is something to steal.
+				std::optional< size_t > entry = Take( sizeWorker );
+				if( ! entry )
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				// Mutate copies of the entry directly in the ring.
+				std::span< const std::byte > spanEntry = m_vecCorpus[ *entry ];
+				for( size_t i = 0; i < m_sizeMutantsPerEntry && ! token.stop_requested(); )
+				{
+					std::span< std::byte > spanSlot = worker.ring.Reserve();
+					if( spanSlot.empty() )
+					{
+						std::this_thread::yield();
+						continue;
+					}
+
+					size_t sizeSeed = std::min( spanEntry.size(), spanSlot.size() );
+					std::ranges::copy( spanEntry.subspan( 0, sizeSeed ), spanSlot.begin() );
+					std::span< std::byte > spanMutant = worker.engine( spanSlot, sizeSeed, worker.generator );
+					worker.ring.Publish( spanMutant.size(), *entry );
+					i++;
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,646 @@
+/*! \file
+Piece table representation of a mutated value where inserting and removing blocks does not move the value.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Mutable value stored as a sequence of pieces that refer either to the original buffer or to an arena.
+
+	Inserting and removing blocks costs O(block size + pieces) instead of moving the rest of the value.
+	The value is flattened back to the original buffer once with Flatten().
+
+	Pieces that refer to the original buffer are always in increasing address order, which allows
+	flattening in place. Bytes inserted to the value are stored in the arena.
+
+	A value can also be a chain of segments that are not in a buffer, such as packet buffers. Such a value
+	is edited in place, cannot be flattened and is read as the list of its pieces.
+	*/
+	class PieceTable
+	{
+	private:
+
+		//! Original buffer containing the value.
+		std::span< byte > m_spanBuffer;
+
+		//! Storage for inserted bytes.
+		std::vector< byte > m_vecArena;
+
+		//! Number of bytes used from the arena.
+		size_t m_sizeArenaUsed = 0;
+
+		//! Pieces that make up the value. Never grows beyond its initial capacity.
+		std::vector< std::span< byte > > m_vecPieces;
+
+		//! Size of the value.
+		size_t m_sizeValue = 0;
+
+	public:
+
+		//! Allocates the arena and the piece storage.
+		explicit PieceTable(
+			size_t sizeArena,  //!< Maximum number of bytes inserted before flattening.
+			size_t sizeMaxPieces = 256  //!< Maximum number of pieces before flattening.
+		) :
+		m_vecArena( sizeArena )
+		{
+			m_vecPieces.reserve( std::max< size_t >( sizeMaxPieces, 1 ) );
+		}
+
+		//! Starts editing a value.
+		void Reset(
+			std::span< byte > spanBuffer,  //!< Buffer where the value is stored and flattened to.
+			size_t sizeValue  //!< Bounds of the value currently contained in buffer.
+		)
+		{
+			m_spanBuffer = spanBuffer;
+			m_sizeValue = std::min( sizeValue, spanBuffer.size() );
+			m_sizeArenaUsed = 0;
+			m_vecPieces.clear();
+			if( m_sizeValue > 0 )
+				m_vecPieces.push_back( spanBuffer.subspan( 0, m_sizeValue ) );
+		}
+
+		/*!
+		Starts editing a value made of a chain of segments.
+
+		The segments are edited in place and must remain valid until the pieces are no longer used. Returns false
+		and leaves the value empty if the segments and the pieces needed for an edit do not fit in the piece storage.
+		*/
+		bool Reset(
+			std::span< const std::span< byte > > spanSegments  //!< Segments that make up the value in order.
+		)
+		{
+			m_spanBuffer = {};
+			m_sizeValue = 0;
+			m_sizeArenaUsed = 0;
+			m_vecPieces.clear();
+			if( spanSegments.size() + 4 > m_vecPieces.capacity() )
+				return false;
+			for( std::span< byte > spanSegment : spanSegments )
+			{
+				if( ! spanSegment.empty() )
+					m_vecPieces.push_back( spanSegment );
+				m_sizeValue += spanSegment.size();
+			}
+			return true;
+		}
+
+		//! Gets the size of the value.
+		size_t Size() const
+		{
+			return m_sizeValue;
+		}
+
+		//! Gets the buffer the value is flattened to.
+		std::span< byte > GetBuffer() const
+		{
+			return m_spanBuffer;
+		}
+
+		//! Gets the pieces that make up the value.
+		std::span< const std::span< byte > > GetPieces() const
+		{
+			return m_vecPieces;
+		}
+
+		//! Gets the number of unused bytes in the arena.
+		size_t GetArenaAvailable() const
+		{
+			return m_vecArena.size() - m_sizeArenaUsed;
+		}
+
+		//! Copies bytes of the value starting from an offset.
+		void Read(
+			size_t sizeOffset,  //!< Offset of the first byte copied.
+			std::span< byte > spanOut  //!< Destination of the bytes. Must fit in the value.
+		) const
+		{
+			assert( sizeOffset + spanOut.size() <= m_sizeValue );
+			ForEachSlice( sizeOffset, spanOut.size(), [ & ]( std::span< byte > spanSlice, size_t sizeDone ) {
+				Details::MoveBytes( spanOut.data() + sizeDone, spanSlice.data(), spanSlice.size() );
+			} );
+		}
+
+		//! Overwrites bytes of the value starting from an offset.
+		void Write(
+			size_t sizeOffset,  //!< Offset of the first byte overwritten.
+			std::span< const byte > spanIn  //!< Bytes that are written. Must fit in the value.
+		)
+		{
+			assert( sizeOffset + spanIn.size() <= m_sizeValue );
+			ForEachSlice( sizeOffset, spanIn.size(), [ & ]( std::span< byte > spanSlice, size_t sizeDone ) {
+				Details::MoveBytes( spanSlice.data(), spanIn.data() + sizeDone, spanSlice.size() );
+			} );
+		}
+
+		//! Checks if an edit that adds a number of pieces and arena bytes fits without flattening.
+		bool CanEdit(
+			size_t sizePieces,  //!< Number of pieces the edit may add.
+			size_t sizeArena  //!< Number of arena bytes the edit allocates.
+		) const
+		{
+			return m_vecPieces.size() + sizePieces <= m_vecPieces.capacity() && sizeArena <= GetArenaAvailable();
+		}
+
+		//! Removes a block from the value. CanEdit( 2, 0 ) must be true.
+		void Erase(
+			size_t sizeOffset,  //!< Offset of the first removed byte.
+			size_t size  //!< Number of bytes removed.
+		)
+		{
+			assert( sizeOffset + size <= m_sizeValue && CanEdit( 2, 0 ) );
+			size_t sizeFirst = Split( sizeOffset );
+			size_t sizeLast = Split( sizeOffset + size );
+			m_vecPieces.erase( m_vecPieces.begin() + sizeFirst, m_vecPieces.begin() + sizeLast );
+			m_sizeValue -= size;
+
+			// Merge the pieces around the removed block if they are adjacent in memory and on the same side of the buffer.
+			if( sizeFirst > 0 && sizeFirst < m_vecPieces.size() )
+			{
+				std::span< byte > spanBefore = m_vecPieces[ sizeFirst - 1 ];
+				std::span< byte > spanAfter = m_vecPieces[ sizeFirst ];
+				if( spanBefore.data() + spanBefore.size() == spanAfter.data() && IsInBuffer( spanBefore ) == IsInBuffer( spanAfter ) )
+				{
+					m_vecPieces[ sizeFirst - 1 ] = { spanBefore.data(), spanBefore.size() + spanAfter.size() };
+					m_vecPieces.erase( m_vecPieces.begin() + sizeFirst );
+				}
+			}
+		}
+
+		//! Allocates bytes from the arena for a block that is inserted later. CanEdit( 0, size ) must be true.
+		std::span< byte > Allocate(
+			size_t size  //!< Number of bytes allocated.
+		)
+		{
+			assert( size <= GetArenaAvailable() );
+			std::span< byte > spanBlock = std::span { m_vecArena }.subspan( m_sizeArenaUsed, size );
+			m_sizeArenaUsed += size;
+			return spanBlock;
+		}
+
+		/*!
+		Inserts a block to the value. CanEdit( 2, 0 ) must be true.
+
+		The block must remain valid until the value is flattened and must not be a part of the buffer.
+		*/
+		void Insert(
+			size_t sizeOffset,  //!< Offset where the block is inserted.
+			std::span< byte > spanBlock  //!< Bytes that are inserted, usually allocated with Allocate().
+		)
+		{
+			assert( sizeOffset <= m_sizeValue && CanEdit( 2, 0 ) && ! IsInBuffer( spanBlock ) );
+			if( spanBlock.empty() )
+				return;
+			size_t sizeIndex = Split( sizeOffset );
+			m_vecPieces.insert( m_vecPieces.begin() + sizeIndex, spanBlock );
+			m_sizeValue += spanBlock.size();
+		}
+
+		/*!
+		Writes the value to the beginning of the buffer and starts a new edit of the flattened value.
+
+		Returns the span of the value in the buffer. A value made of segments cannot be flattened.
+		*/
+		std::span< byte > Flatten()
+		{
+			assert( ! m_spanBuffer.empty() || m_vecPieces.empty() );
+			// Pieces in the buffer are in increasing address order.
+			// Pieces moving left are moved front to back and pieces moving right back to front,
+			// so no piece overwrites bytes of the buffer that another piece has not yet moved.
+			byte* pBuffer = m_spanBuffer.data();
+			size_t sizeOffset = 0;
+			for( std::span< byte > spanPiece : m_vecPieces )
+			{
+				if( IsInBuffer( spanPiece ) && spanPiece.data() >= pBuffer + sizeOffset )
+					Details::MoveBytes( pBuffer + sizeOffset, spanPiece.data(), spanPiece.size() );
+				sizeOffset += spanPiece.size();
+			}
+			for( auto it = m_vecPieces.rbegin(); it != m_vecPieces.rend(); ++it )
+			{
+				sizeOffset -= it->size();
+				if( IsInBuffer( *it ) && it->data() < pBuffer + sizeOffset )
+					Details::MoveBytes( pBuffer + sizeOffset, it->data(), it->size() );
+			}
+
+			// Copy the pieces outside the buffer after the buffer has been rearranged.
+			for( std::span< byte > spanPiece : m_vecPieces )
+			{
+				if( ! IsInBuffer( spanPiece ) )
+					Details::MoveBytes( pBuffer + sizeOffset, spanPiece.data(), spanPiece.size() );
+				sizeOffset += spanPiece.size();
+			}
+
+			Reset( m_spanBuffer, m_sizeValue );
+			return m_spanBuffer.subspan( 0, m_sizeValue );
+		}
+
+	private:
+
+		//! Returns true if a piece refers to the original buffer.
+		bool IsInBuffer(
+			std::span< const byte > spanPiece  //!< Piece that is checked.
+		) const
+		{
+			std::less_equal< const byte* > lessEqual;
+			return lessEqual( m_spanBuffer.data(), spanPiece.data() ) &&
+					lessEqual( spanPiece.data() + spanPiece.size(), m_spanBuffer.data() + m_spanBuffer.size() );
+		}
+
+		//! Splits the piece containing an offset so that a piece begins at the offset. Returns the index of that piece.
+		size_t Split(
+			size_t sizeOffset  //!< Offset where a piece must begin.
+		)
+		{
+			size_t sizeBegin = 0;
+			for( size_t i = 0; i < m_vecPieces.size(); i++ )
+			{
+				std::span< byte > spanPiece = m_vecPieces[ i ];
+				if( sizeOffset == sizeBegin )
+					return i;
+				if( sizeOffset < sizeBegin + spanPiece.size() )
+				{
+					size_t sizeHead = sizeOffset - sizeBegin;
+					m_vecPieces[ i ] = spanPiece.subspan( 0, sizeHead );
+					m_vecPieces.insert( m_vecPieces.begin() + i + 1, spanPiece.subspan( sizeHead ) );
+					return i + 1;
+				}
+				sizeBegin += spanPiece.size();
+			}
+			return m_vecPieces.size();
+		}
+
+		//! Calls a function for each part of the pieces that overlaps a range of the value.
+		template< class F >
+		void ForEachSlice(
+			size_t sizeOffset,  //!< Offset of the range.
+			size_t size,  //!< Size of the range.
+			F&& f  //!< Function called with the slice and the number of bytes of the range before it.
+		) const
+		{
+			size_t sizeBegin = 0;
+			size_t sizeDone = 0;
+			for( std::span< byte > spanPiece : m_vecPieces )
+			{
+				if( sizeDone == size )
+					break;
+				size_t sizeEnd = sizeBegin + spanPiece.size();
+				if( sizeOffset + sizeDone < sizeEnd )
+				{
+					size_t sizeSkip = sizeOffset + sizeDone - sizeBegin;
+					std::span< byte > spanSlice = spanPiece.subspan( sizeSkip, std::min( spanPiece.size() - sizeSkip, size - sizeDone ) );
+					f( spanSlice, sizeDone );
+					sizeDone += spanSlice.size();
+				}
+				sizeBegin = sizeEnd;
+			}
+		}
+	};
+
+	namespace Details
+	{
+		//! Fills a block with bytes cloned from the value or a repeated byte like FillSubrangeWithRandomValues.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		void FillBlockFromPieces(
+			const PieceTable& table,  //!< Value the bytes may be cloned from.
+			std::span< byte > spanBlock,  //!< Block that is filled. Must not be a part of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			// Clone bytes with 0.75 probability. Otherwise repeat a random byte.
+			size_t sizeValue = table.Size();
+			if( sizeValue > 1 && RandomInRange( 0u, 3u, generator ) != 0 )
+			{
+				size_t sizeClone = std::min( sizeValue, spanBlock.size() );
+				size_t sizeSource = RandomInRange< size_t >( 0, sizeValue - sizeClone, generator );
+				table.Read( sizeSource, spanBlock.subspan( 0, sizeClone ) );
+			}
+			else
+			{
+				std::array< byte, 1 > arrayByte {};
+				if( sizeValue > 0 && RandomInRange( 0u, 1u, generator ) == 0 )
+					table.Read( RandomInRange< size_t >( 0, sizeValue - 1, generator ), arrayByte );
+				else
+					arrayByte[ 0 ] = static_cast< byte >( RandomInRange( 0u, 255u, generator ) );
+				FillBytes( spanBlock, arrayByte[ 0 ] );
+			}
+		}
+	}
+
+	namespace Details
+	{
+		//! Operation of a piece table that applies a mutation.
+		enum class PieceOperation
+		{
+			Window = 0,  //!< The mutation is applied to a copy of a window of the value.
+			Remove,  //!< A block is erased like RemoveRandomBlock does.
+			Insert,  //!< A block is inserted like RandomBlockInsert does.
+			Overwrite,  //!< A block is replaced like RandomChunkOverwrite does.
+			Contiguous  //!< The value is flattened and the mutation is applied to the buffer.
+		};
+
+		//! How a piece table applies a mutation of a list.
+		struct PieceDispatch
+		{
+			PieceOperation operation = PieceOperation::Contiguous;  //!< Operation that applies the mutation.
+			size_t sizeWindow = 0;  //!< Width of the window of window mutations.
+		};
+
+		//! Largest window of a size-constant mutation that is applied to a copy of the window.
+		inline constexpr size_t MaxPieceWindow = sizeof( uint64_t );
+
+		//! Type that identifies a mutation of a list.
+		template< auto fMutation >
+		struct MutationTag
+		{
+		};
+
+		/*!
+		Whether two mutations of lists are the same function.
+
+		The mutations are compared as template arguments rather than as pointers, because some compilers do not
+		accept comparisons of function pointers in constant expressions when null pointer checks are instrumented.
+		*/
+		template< auto fLeft, auto fRight >
+		inline constexpr bool IsSameMutation = std::is_same_v< MutationTag< fLeft >, MutationTag< fRight > >;
+
+		/*!
+		Gets the number of adjacent bytes a size-constant mutation reads and writes at most.
+
+		Returns zero for mutations that may touch the whole value.
+		*/
+		template< auto fMutation, class Gen >
+		consteval size_t GetMutationWindow()
+		{
+			if constexpr( IsSameMutation< fMutation, &FlipBit< Gen > > || IsSameMutation< fMutation, &RandomByteReplace< Gen > > )
+				return 1;
+			else if constexpr( IsSameMutation< fMutation, &InterestingValue< Gen > > ||
+					IsSameMutation< fMutation, &Arithmetic< Gen, std::plus< uint64_t > > > ||
+					IsSameMutation< fMutation, &Arithmetic< Gen, std::minus< uint64_t > > > ||
+					IsSameMutation< fMutation, &ArithmeticSmallDelta< Gen, std::plus< uint64_t > > > ||
+					IsSameMutation< fMutation, &ArithmeticSmallDelta< Gen, std::minus< uint64_t > > > )
+				return sizeof( uint64_t );
+			else
+				return 0;
+		}
+
+		//! Classifies a mutation by its function.
+		template< auto fMutation, class Gen >
+		consteval PieceDispatch ClassifyPieceMutation()
+		{
+			constexpr size_t sizeWindow = GetMutationWindow< fMutation, Gen >();
+			static_assert( sizeWindow <= MaxPieceWindow );
+			if constexpr( sizeWindow > 0 )
+				return PieceDispatch { PieceOperation::Window, sizeWindow };
+			else if constexpr( IsSameMutation< fMutation, &RemoveRandomBlock< Gen > > )
+				return PieceDispatch { PieceOperation::Remove };
+			else if constexpr( IsSameMutation< fMutation, &RandomBlockInsert< Gen > > )
+				return PieceDispatch { PieceOperation::Insert };
+			else if constexpr( IsSameMutation< fMutation, &RandomChunkOverwrite< Gen > > )
+				return PieceDispatch { PieceOperation::Overwrite };
+			else
+				return PieceDispatch { PieceOperation::Contiguous };
+		}
+
+		//! Classifies every mutation of a list in the order of the list.
+		template< class Gen, auto... fMutations >
+		consteval auto GetPieceDispatch(
+			Ops< fMutations... >  //!< List of the mutations.
+		)
+		{
+			return std::array< PieceDispatch, sizeof...( fMutations ) > { ClassifyPieceMutation< fMutations, Gen >()... };
+		}
+
+		//! Applies a size-constant mutation to a copy of a window of the value and writes it back.
+		template< class Gen, class Mutation >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		void MutatePieceWindow(
+			PieceTable& table,  //!< Value that is mutated.
+			const Mutation& mutation,  //!< Mutation that is applied.
+			size_t sizeMaxWindow,  //!< Width of the window of the mutation.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			std::array< byte, MaxPieceWindow > arrayWindow {};
+			size_t sizeCurrent = table.Size();
+			size_t sizeWindow = std::min( sizeMaxWindow, sizeCurrent );
+			size_t sizeOffset = RandomInRange< size_t >( 0, sizeCurrent - sizeWindow, generator );
+			std::span< byte > spanWindow = std::span { arrayWindow }.subspan( 0, sizeWindow );
+			table.Read( sizeOffset, spanWindow );
+			mutation( spanWindow, sizeWindow, generator );
+			table.Write( sizeOffset, spanWindow );
+		}
+
+		//! Offset and size of a structural edit of a piece table.
+		struct PieceEdit
+		{
+			size_t sizeOffset = 0;  //!< Offset of the edited block.
+			size_t sizeBlock = 0;  //!< Size of the edited block.
+			size_t sizeArena = 0;  //!< Number of arena bytes the edit allocates.
+		};
+
+		//! Draws the parameters of a structural mutation like the contiguous mutations do.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		PieceEdit DrawPieceEdit(
+			PieceOperation operation,  //!< Structural operation of the mutation.
+			size_t sizeCapacity,  //!< Maximum size of the value.
+			size_t sizeCurrent,  //!< Current size of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			PieceEdit edit;
+			if( operation == PieceOperation::Remove )
+			{
+				// RemoveRandomBlock
+				edit.sizeOffset = RandomInRange< size_t >( 0, sizeCurrent - 1, generator );
+				edit.sizeBlock = RandomInRange< size_t >( 1, sizeCurrent - edit.sizeOffset, generator );
+			}
+			else if( operation == PieceOperation::Insert )
+			{
+				// RandomBlockInsert
+				edit.sizeBlock = RandomInRange< size_t >( 1, sizeCapacity - sizeCurrent, generator );
+				edit.sizeOffset = RandomInRange< size_t >( 0, sizeCurrent, generator );
+			}
+			else
+			{
+				// RandomChunkOverwrite
+				edit.sizeBlock = RandomInRange< size_t >( 1, sizeCurrent, generator );
+				edit.sizeOffset = RandomInRange< size_t >( 0, sizeCurrent - edit.sizeBlock, generator );
+			}
+			edit.sizeArena = operation == PieceOperation::Remove ? 0 : edit.sizeBlock;
+			return edit;
+		}
+
+		//! Applies a structural mutation that fits in the piece table.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		void ApplyPieceEdit(
+			PieceTable& table,  //!< Value that is mutated.
+			PieceOperation operation,  //!< Structural operation of the mutation.
+			const PieceEdit& edit,  //!< Parameters of the edit.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			assert( table.CanEdit( 4, edit.sizeArena ) );
+			if( operation == PieceOperation::Remove )
+			{
+				table.Erase( edit.sizeOffset, edit.sizeBlock );
+			}
+			else
+			{
+				// The block is filled before it is inserted so that it cannot be cloned from itself.
+				std::span< byte > spanBlock = table.Allocate( edit.sizeBlock );
+				FillBlockFromPieces( table, spanBlock, generator );
+				if( operation == PieceOperation::Overwrite )
+					table.Erase( edit.sizeOffset, edit.sizeBlock );
+				table.Insert( edit.sizeOffset, spanBlock );
+			}
+		}
+	}
+
+	/*!
+	Applies a number of havoc mutations in place using a piece table for the structural edits.
+
+	Uses the default mutations. Size-constant mutations that touch at most 8 bytes are applied to a copy of a
+	window of the value; for InterestingValue and Arithmetic this draws positions within 7 bytes of the ends
+	of the value slightly less often than Havoc(). Blocks are inserted, removed and overwritten through the
+	piece table, and the value is flattened back to the buffer once at the end of the round. The mutations are
+	matched to these operations by their functions at compile-time. If an edit does not fit in the piece table
+	or a mutation has no operation, the value is flattened and the contiguous mutation is used instead.
+	*/
+	template< unsigned int MaxIterationsPower = 5, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	std::span< std::byte > PieceTableHavoc(
+		PieceTable& table,  //!< Piece table that is reused between rounds.
+		std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Classify the default mutations by their size effects and by the piece table operation that applies them.
+		static constexpr auto arrayMutations = GetMutationTable< Gen >();
+		static constexpr Details::EligibleMutations< arrayMutations.size() > eligible { arrayMutations };
+		static constexpr auto arrayDispatch = Details::GetPieceDispatch< Gen >( DefaultOps< Gen > {} );
+
+		// Nothing can be mutated in an empty buffer.
+		table.Reset( spanBuffer, sizeValue );
+		size_t sizeOriginal = table.Size();
+		size_t sizeLargest = sizeOriginal;
+		if( spanBuffer.empty() )
+			return spanBuffer;
+
+		// Apply a round of mutations.
+		unsigned int uiHavocIterations = PowerOfTwoDepth< MaxIterationsPower >::Draw( sizeValue, generator );
+		for( unsigned int i = 0; i < uiHavocIterations; i++ )
+		{
+			// Select a suitable mutation based on the buffer and value sizes.
+			size_t sizeCurrent = table.Size();
+			Details::SizeState state = Details::GetSizeState( spanBuffer.size(), sizeCurrent );
+			size_t index = eligible.SelectRandom( state, generator );
+			const Details::PieceDispatch& dispatch = arrayDispatch[ index ];
+			if( dispatch.operation == Details::PieceOperation::Window )
+			{
+				Details::MutatePieceWindow( table, arrayMutations[ index ], dispatch.sizeWindow, generator );
+				continue;
+			}
+
+			// Fall back to the contiguous mutation when the operation has no edit or the edit does not fit.
+			Details::PieceEdit edit;
+			if( dispatch.operation != Details::PieceOperation::Contiguous )
+				edit = Details::DrawPieceEdit( dispatch.operation, spanBuffer.size(), sizeCurrent, generator );
+			if( dispatch.operation == Details::PieceOperation::Contiguous || ! table.CanEdit( 4, edit.sizeArena ) )
+			{
+				std::span< byte > spanValue = table.Flatten();
+				if( dispatch.operation == Details::PieceOperation::Contiguous || ! table.CanEdit( 4, edit.sizeArena ) )
+				{
+					spanValue = arrayMutations[ index ]( spanBuffer, spanValue.size(), generator );
+					table.Reset( spanBuffer, spanValue.size() );
+					sizeLargest = std::max( sizeLargest, spanValue.size() );
+					continue;
+				}
+			}
+
+			// Apply the edit.
+			Details::ApplyPieceEdit( table, dispatch.operation, edit, generator );
+			sizeLargest = std::max( sizeLargest, table.Size() );
+		}
+
+		// Flatten the value and zero the bytes it no longer covers.
+		std::span< byte > spanValue = table.Flatten();
+		Details::FillBytes( spanBuffer.subspan( spanValue.size(), sizeLargest - std::min( sizeLargest, spanValue.size() ) ), byte { 0 } );
+		return spanValue;
+	}
+
+	/*!
+	Applies a number of havoc mutations to a value made of a chain of segments without flattening it.
+
+	The segments are mutated in place. Removing a block splits or drops segments, and inserted blocks are new
+	segments in the arena of the piece table, so no segment is shifted. The mutated value is the returned list
+	of segments, which stays valid until the piece table is reset and can be written with a single gather
+	write. Uses the default mutations like PieceTableHavoc. Structural edits that do not fit in the piece
+	table are skipped. If the segments do not fit in the piece table, they are returned unchanged.
+	*/
+	template< unsigned int MaxIterationsPower = 5, class Gen >
+		requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+	std::span< const std::span< std::byte > > SegmentedHavoc(
+		PieceTable& table,  //!< Piece table that is reused between rounds.
+		std::span< const std::span< std::byte > > spanSegments,  //!< Segments that make up the value in order.
+		size_t sizeCapacity,  //!< Maximum size of the mutated value.
+		Gen& generator  //!< Random number generator used as the source of randomness.
+	)
+	{
+		// Classify the default mutations. Segments cannot be flattened, so every mutation needs a piece table operation.
+		static constexpr auto arrayMutations = GetMutationTable< Gen >();
+		static constexpr Details::EligibleMutations< arrayMutations.size() > eligible { arrayMutations };
+		static constexpr auto arrayDispatch = Details::GetPieceDispatch< Gen >( DefaultOps< Gen > {} );
+		static_assert( std::ranges::none_of( arrayDispatch, []( const Details::PieceDispatch& dispatch ) {
+			return dispatch.operation == Details::PieceOperation::Contiguous;
+		} ) );
+
+		// Nothing can be mutated without any capacity.
+		if( ! table.Reset( spanSegments ) )
+			return spanSegments;
+		sizeCapacity = std::max( sizeCapacity, table.Size() );
+		if( sizeCapacity == 0 )
+			return table.GetPieces();
+
+		// Apply a round of mutations.
+		unsigned int uiHavocIterations = PowerOfTwoDepth< MaxIterationsPower >::Draw( table.Size(), generator );
+		for( unsigned int i = 0; i < uiHavocIterations; i++ )
+		{
+			// Select a suitable mutation based on the capacity and value sizes.
+			size_t sizeCurrent = table.Size();
+			Details::SizeState state = Details::GetSizeState( sizeCapacity, sizeCurrent );
+			size_t index = eligible.SelectRandom( state, generator );
+			const Details::PieceDispatch& dispatch = arrayDispatch[ index ];
+			if( dispatch.operation == Details::PieceOperation::Window )
+			{
+				Details::MutatePieceWindow( table, arrayMutations[ index ], dispatch.sizeWindow, generator );
+				continue;
+			}
+
+			// Skip the edits that do not fit.
+			Details::PieceEdit edit = Details::DrawPieceEdit( dispatch.operation, sizeCapacity, sizeCurrent, generator );
+			if( table.CanEdit( 4, edit.sizeArena ) )
+				Details::ApplyPieceEdit( table, dispatch.operation, edit, generator );
+		}
+
+		return table.GetPieces();
+	}
+}
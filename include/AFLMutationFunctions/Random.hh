@@ -0,0 +1,331 @@
+/*! \file
+Fast random number generation for the mutation functions.
+*/
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace AFLMutationFunctions
+{
+	/*!
+	xoshiro256** pseudorandom number generator by David Blackman and Sebastiano Vigna.
+
+	Satisfies std::uniform_random_bit_generator and produces full 64-bit values.
+	*/
+	class Xoshiro256StarStar
+	{
+	public:
+
+		//! Type of the generated values.
+		using result_type = uint64_t;
+
+	private:
+
+		//! State of the generator. Must not be all zeros.
+		std::array< uint64_t, 4 > m_arrayState {};
+
+	public:
+
+		//! Creates a generator with a fixed seed.
+		constexpr Xoshiro256StarStar() :
+		Xoshiro256StarStar( 0 )
+		{
+		}
+
+		//! Creates a generator from a seed.
+		constexpr explicit Xoshiro256StarStar(
+			uint64_t ui64Seed  //!< Seed that is expanded to the full state.
+		)
+		{
+			Seed( ui64Seed );
+		}
+
+		//! Resets the state of the generator from a seed.
+		constexpr void Seed(
+			uint64_t ui64Seed  //!< Seed that is expanded to the full state.
+		)
+		{
+			// Expand the seed with SplitMix64 as recommended by the authors.
+			for( uint64_t& ui64State : m_arrayState )
+			{
+				ui64Seed += 0x9e3779b97f4a7c15;
+				uint64_t z = ui64Seed;
+				z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9;
+				z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111eb;
+				ui64State = z ^ ( z >> 31 );
+			}
+		}
+
+		//! Gets the smallest value the generator produces.
+		static constexpr result_type min()
+		{
+			return std::numeric_limits< result_type >::min();
+		}
+
+		//! Gets the largest value the generator produces.
+		static constexpr result_type max()
+		{
+			return std::numeric_limits< result_type >::max();
+		}
+
+		//! Generates the next value.
+		constexpr result_type operator()()
+		{
+			const uint64_t ui64Result = std::rotl( m_arrayState[ 1 ] * 5, 7 ) * 9;
+			const uint64_t ui64Shifted = m_arrayState[ 1 ] << 17;
+			m_arrayState[ 2 ] ^= m_arrayState[ 0 ];
+			m_arrayState[ 3 ] ^= m_arrayState[ 1 ];
+			m_arrayState[ 1 ] ^= m_arrayState[ 2 ];
+			m_arrayState[ 0 ] ^= m_arrayState[ 3 ];
+			m_arrayState[ 2 ] ^= ui64Shifted;
+			m_arrayState[ 3 ] = std::rotl( m_arrayState[ 3 ], 45 );
+			return ui64Result;
+		}
+
+		/*!
+		Advances the generator by 2^128 values.
+
+		Generators created by repeatedly jumping a copy of a generator produce non-overlapping streams.
+		*/
+		constexpr void Jump()
+		{
+			constexpr std::array< uint64_t, 4 > arrayJump {
+				0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+			std::array< uint64_t, 4 > arrayState {};
+			for( uint64_t ui64Jump : arrayJump )
+			{
+				for( int b = 0; b < 64; b++ )
+				{
+					if( ui64Jump & ( uint64_t { 1 } << b ) )
+					{
+						for( size_t i = 0; i < arrayState.size(); i++ )
+							arrayState[ i ] ^= m_arrayState[ i ];
+					}
+					( *this )();
+				}
+			}
+			m_arrayState = arrayState;
+		}
+
+		//! Compares the states of two generators.
+		constexpr bool operator==( const Xoshiro256StarStar& ) const = default;
+	};
+
+	namespace Details
+	{
+		//! Concept for a generator that produces uniformly distributed full 64-bit values.
+		template< class Gen >
+		concept FullWidth64 = std::uniform_random_bit_generator< std::remove_reference_t< Gen > > &&
+				std::remove_reference_t< Gen >::min() == 0 &&
+				std::remove_reference_t< Gen >::max() == std::numeric_limits< uint64_t >::max();
+
+		//! Concept for a generator that implements bounded draws itself.
+		template< class Gen >
+		concept BoundedSource = requires( Gen& generator, uint64_t ui64Low, uint64_t ui64High ) {
+			{
+				generator.Uniform( ui64Low, ui64High )
+			} -> std::convertible_to< uint64_t >;
+		};
+
+		//! Multiplies two 64-bit integers and returns the high and low halves of the 128-bit product.
+		constexpr std::pair< uint64_t, uint64_t > MultiplyWide(
+			uint64_t a,  //!< First factor.
+			uint64_t b  //!< Second factor.
+		)
+		{
+#if defined( __SIZEOF_INT128__ )
+			unsigned __int128 product = static_cast< unsigned __int128 >( a ) * b;
+			return { static_cast< uint64_t >( product >> 64 ), static_cast< uint64_t >( product ) };
+#else
+			// Multiply 32-bit halves.
+			uint64_t aLow = a & 0xffffffff, aHigh = a >> 32;
+			uint64_t bLow = b & 0xffffffff, bHigh = b >> 32;
+			uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+			uint64_t middle = ( ll >> 32 ) + ( lh & 0xffffffff ) + ( hl & 0xffffffff );
+			return { hh + ( lh >> 32 ) + ( hl >> 32 ) + ( middle >> 32 ), ( middle << 32 ) | ( ll & 0xffffffff ) };
+#endif
+		}
+
+		/*!
+		Draws a uniformly distributed integer in range [0, ui64Range) with Lemire's multiply-shift method.
+
+		ui64Range must not be zero. fDraw must return uniformly distributed 64-bit values.
+		*/
+		template< class Draw >
+		constexpr uint64_t Lemire64(
+			uint64_t ui64Range,  //!< Number of possible values.
+			Draw&& fDraw  //!< Function that returns random 64-bit values.
+		)
+		{
+			// Reject the few low halves that would bias the result.
+			assert( ui64Range > 0 );
+			auto [ ui64High, ui64Low ] = MultiplyWide( fDraw(), ui64Range );
+			if( ui64Low < ui64Range )
+			{
+				uint64_t ui64Threshold = ( 0 - ui64Range ) % ui64Range;
+				while( ui64Low < ui64Threshold )
+					std::tie( ui64High, ui64Low ) = MultiplyWide( fDraw(), ui64Range );
+			}
+			return ui64High;
+		}
+
+		/*!
+		Draws a uniformly distributed integer in range [low, high].
+
+		Generators that implement bounded draws themselves are used directly. Full-width 64-bit generators
+		use Lemire's method. Other generators fall back to std::uniform_int_distribution.
+		*/
+		template< std::unsigned_integral T, class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		constexpr T RandomInRange(
+			T low,  //!< Smallest possible value.
+			T high,  //!< Largest possible value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			assert( low <= high );
+			if constexpr( BoundedSource< Gen > )
+			{
+				return static_cast< T >( generator.Uniform( low, high ) );
+			}
+			else if constexpr( FullWidth64< Gen > )
+			{
+				// The full range needs no reduction.
+				uint64_t ui64Span = static_cast< uint64_t >( high - low );
+				if( ui64Span == std::numeric_limits< uint64_t >::max() )
+					return static_cast< T >( generator() );
+				return static_cast< T >( low + Lemire64( ui64Span + 1, generator ) );
+			}
+			else
+			{
+				return std::uniform_int_distribution< T >( low, high )( generator );
+			}
+		}
+	}
+
+	/*!
+	Random bit generator adaptor that serves small bounded draws from buffered random bits.
+
+	Satisfies std::uniform_random_bit_generator. Unbounded draws are forwarded to the base generator.
+	Bounded draws below 2^32 consume only the bits they need from a 64-bit reservoir and are
+	reduced with Lemire's multiply-shift method.
+	*/
+	template< class Gen >
+		requires Details::FullWidth64< Gen >
+	class RandomBitPool
+	{
+	public:
+
+		//! Type of the generated values.
+		using result_type = uint64_t;
+
+	private:
+
+		//! Generator that provides the random bits.
+		Gen m_generator;
+
+		//! Buffered random bits.
+		uint64_t m_ui64Bits = 0;
+
+		//! Number of unused bits in m_ui64Bits.
+		unsigned int m_uiAvailable = 0;
+
+	public:
+
+		//! Creates a pool with a default-constructed base generator.
+		constexpr RandomBitPool() = default;
+
+		//! Creates a pool from a base generator.
+		constexpr explicit RandomBitPool(
+			Gen generator  //!< Generator that provides the random bits.
+		) :
+		m_generator { std::move( generator ) }
+		{
+		}
+
+		//! Gets the smallest value the generator produces.
+		static constexpr result_type min()
+		{
+			return std::numeric_limits< result_type >::min();
+		}
+
+		//! Gets the largest value the generator produces.
+		static constexpr result_type max()
+		{
+			return std::numeric_limits< result_type >::max();
+		}
+
+		//! Generates a full 64-bit value from the base generator.
+		constexpr result_type operator()()
+		{
+			return m_generator();
+		}
+
+		//! Draws a number of random bits. At most 32 bits can be drawn at a time.
+		constexpr uint64_t Bits(
+			unsigned int uiCount  //!< Number of bits to draw.
+		)
+		{
+			// Refill the reservoir if it does not contain enough bits.
+			assert( uiCount > 0 && uiCount <= 32 );
+			if( m_uiAvailable < uiCount )
+			{
+				m_ui64Bits = m_generator();
+				m_uiAvailable = 64;
+			}
+
+			uint64_t ui64Result = m_ui64Bits & ( ( uint64_t { 1 } << uiCount ) - 1 );
+			m_ui64Bits >>= uiCount;
+			m_uiAvailable -= uiCount;
+			return ui64Result;
+		}
+
+		//! Draws a uniformly distributed integer in range [low, high].
+		constexpr uint64_t Uniform(
+			uint64_t low,  //!< Smallest possible value.
+			uint64_t high  //!< Largest possible value.
+		)
+		{
+			assert( low <= high );
+			uint64_t ui64Span = high - low;
+			if( ui64Span > std::numeric_limits< uint32_t >::max() )
+			{
+				// Large ranges use whole values from the base generator.
+				if( ui64Span == std::numeric_limits< uint64_t >::max() )
+					return m_generator();
+				return low + Details::Lemire64( ui64Span + 1, m_generator );
+			}
+
+			// Ranges that are powers of two need no reduction.
+			uint64_t ui64Range = ui64Span + 1;
+			if( std::has_single_bit( ui64Range ) )
+				return ui64Range == 1 ? low : low + Bits( std::countr_zero( ui64Range ) );
+
+			// Use Lemire's method with 32-bit draws.
+			uint64_t ui64Product = Bits( 32 ) * ui64Range;
+			if( static_cast< uint32_t >( ui64Product ) < ui64Range )
+			{
+				uint32_t ui32Threshold = static_cast< uint32_t >( ( uint64_t { 1 } << 32 ) % ui64Range );
+				while( static_cast< uint32_t >( ui64Product ) < ui32Threshold )
+					ui64Product = Bits( 32 ) * ui64Range;
+			}
+			return low + ( ui64Product >> 32 );
+		}
+
+		//! Gets the base generator.
+		constexpr const Gen& Base() const
+		{
+			return m_generator;
+		}
+	};
+}
@@ -0,0 +1,375 @@
+/*! \file
+Schedulers that select which havoc mutation is applied next.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+
+#include "AFLMutationFunctions/Details.hh"
+#include "AFLMutationFunctions/Random.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Concept for an object that selects mutations from a mutation table.
+	template< class S, class Gen >
+	concept MutationScheduler = requires( S& scheduler, Details::SizeState state, Gen& generator ) {
+		{
+			scheduler.CanSelect( state )
+		} -> std::convertible_to< bool >;
+		{
+			scheduler.Select( state, generator )
+		} -> std::convertible_to< size_t >;
+	};
+
+	namespace Details
+	{
+		/*!
+		Alias table for sampling a weighted discrete distribution in constant time.
+
+		The table is built with Vose's alias method.
+		*/
+		template< size_t Capacity >
+		class AliasTable
+		{
+		private:
+
+			//! Values that are sampled.
+			std::array< uint8_t, Capacity > m_arrayValues {};
+
+			//! Values that are sampled when the coin flip of a column fails.
+			std::array< uint8_t, Capacity > m_arrayAliases {};
+
+			//! Probabilities of sampling the value of a column, scaled to the range of uint32_t.
+			std::array< uint32_t, Capacity > m_arrayThresholds {};
+
+			//! Number of columns in the table.
+			size_t m_sizeColumns = 0;
+
+		public:
+
+			//! Builds the table. Values with zero weight are never sampled.
+			constexpr void Build(
+				std::span< const uint8_t > spanValues,  //!< Values that are sampled.
+				std::span< const double > spanWeights  //!< Weights of the values sampled, indexed by value.
+			)
+			{
+				// Collect the columns that have some weight.
+				assert( spanValues.size() <= Capacity );
+				std::array< double, Capacity > arrayScaled {};
+				double dTotal = 0;
+				m_sizeColumns = 0;
+				for( uint8_t value : spanValues )
+				{
+					double dWeight = value < spanWeights.size() ? spanWeights[ value ] : 0.0;
+					if( dWeight <= 0 )
+						continue;
+					m_arrayValues[ m_sizeColumns ] = value;
+					m_arrayAliases[ m_sizeColumns ] = value;
+					arrayScaled[ m_sizeColumns ] = dWeight;
+					dTotal += dWeight;
+					m_sizeColumns++;
+				}
+
+				// Scale the weights so that the average column has a weight of 1.
+				std::array< uint8_t, Capacity > arraySmall {};
+				std::array< uint8_t, Capacity > arrayLarge {};
+				size_t sizeSmall = 0;
+				size_t sizeLarge = 0;
+				for( size_t i = 0; i < m_sizeColumns; i++ )
+				{
+					arrayScaled[ i ] *= m_sizeColumns / dTotal;
+					if( arrayScaled[ i ] < 1.0 )
+						arraySmall[ sizeSmall++ ] = static_cast< uint8_t >( i );
+					else
+						arrayLarge[ sizeLarge++ ] = static_cast< uint8_t >( i );
+				}
+
+				// Fill the small columns with the excess of the large columns.
+				while( sizeSmall > 0 && sizeLarge > 0 )
+				{
+					uint8_t small = arraySmall[ --sizeSmall ];
+					uint8_t large = arrayLarge[ sizeLarge - 1 ];
+					m_arrayThresholds[ small ] = ToThreshold( arrayScaled[ small ] );
+					m_arrayAliases[ small ] = m_arrayValues[ large ];
+					arrayScaled[ large ] -= 1.0 - arrayScaled[ small ];
+					if( arrayScaled[ large ] < 1.0 )
+					{
+						sizeLarge--;
+						arraySmall[ sizeSmall++ ] = large;
+					}
+				}
+
+				// The remaining columns are full due to rounding.
+				for( size_t i = 0; i < sizeSmall; i++ )
+					m_arrayThresholds[ arraySmall[ i ] ] = std::numeric_limits< uint32_t >::max();
+				for( size_t i = 0; i < sizeLarge; i++ )
+					m_arrayThresholds[ arrayLarge[ i ] ] = std::numeric_limits< uint32_t >::max();
+			}
+
+			//! Returns true if the table contains no values.
+			constexpr bool IsEmpty() const
+			{
+				return m_sizeColumns == 0;
+			}
+
+			//! Samples a value from the table. The table must not be empty.
+			template< class Gen >
+				requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+			size_t Sample(
+				Gen& generator  //!< Random number generator used as the source of randomness.
+			) const
+			{
+				// Select a random column and flip a biased coin to choose between the value and its alias.
+				assert( ! IsEmpty() );
+				size_t column = RandomInRange< size_t >( 0, m_sizeColumns - 1, generator );
+				uint32_t ui32Coin = RandomInRange( uint32_t { 0 }, std::numeric_limits< uint32_t >::max(), generator );
+				return ui32Coin < m_arrayThresholds[ column ] ? m_arrayValues[ column ] : m_arrayAliases[ column ];
+			}
+
+		private:
+
+			//! Converts a probability to a threshold for a 32-bit coin flip.
+			static constexpr uint32_t ToThreshold(
+				double dProbability  //!< Probability in range [0, 1].
+			)
+			{
+				constexpr double dScale = std::numeric_limits< uint32_t >::max();
+				return static_cast< uint32_t >( std::clamp( dProbability, 0.0, 1.0 ) * dScale );
+			}
+		};
+	}
+
+	//! Scheduler that selects any suitable mutation with equal probability.
+	template< size_t Capacity = 32 >
+	class UniformScheduler
+	{
+	private:
+
+		//! Mutations that are suitable for each size state.
+		Details::EligibleMutations< Capacity > m_eligible;
+
+	public:
+
+		//! Classifies the mutations of a mutation table.
+		template< std::ranges::contiguous_range Range >
+		constexpr void Initialize(
+			const Range& mutations  //!< Mutation table used by the engine.
+		)
+		{
+			m_eligible = Details::EligibleMutations< Capacity > { mutations };
+		}
+
+		//! Returns true if some mutation is suitable for the size state.
+		constexpr bool CanSelect(
+			Details::SizeState state  //!< Size state of the value.
+		) const
+		{
+			return ! m_eligible.Get( state ).empty();
+		}
+
+		//! Selects the index of a random suitable mutation.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		size_t Select(
+			Details::SizeState state,  //!< Size state of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		) const
+		{
+			return m_eligible.SelectRandom( state, generator );
+		}
+	};
+
+	//! Statistics of a single mutation collected by WeightedScheduler.
+	struct MutationStatistics
+	{
+		uint64_t ui64Selections = 0;  //!< Number of times the mutation was applied.
+		uint64_t ui64Rounds = 0;  //!< Number of reported rounds where the mutation was applied.
+		uint64_t ui64Finds = 0;  //!< Number of reported rounds with new coverage where the mutation was applied.
+	};
+
+	/*!
+	Scheduler that selects mutations with configurable weights and adapts the weights to feedback.
+
+	Mutations are sampled from alias tables in constant time. After a round the caller reports
+	whether the mutated input found new coverage. Every mutation applied in the round is credited,
+	and the effective weights are periodically scaled by each mutation's relative find rate.
+	*/
+	template< size_t Capacity = 32 >
+	class WeightedScheduler
+	{
+	public:
+
+		//! Smallest factor the feedback may scale a configured weight with.
+		static constexpr double MinimumFactor = 0.125;
+
+		//! Largest factor the feedback may scale a configured weight with.
+		static constexpr double MaximumFactor = 8.0;
+
+	private:
+
+		//! Number of size states.
+		static constexpr size_t States = 3;
+
+		//! Weights configured by the user.
+		std::array< double, Capacity > m_arrayBaseWeights {};
+
+		//! Weights currently used for sampling.
+		std::array< double, Capacity > m_arrayWeights {};
+
+		//! Mutations that are suitable for each size state.
+		Details::EligibleMutations< Capacity > m_eligible;
+
+		//! Alias table for each size state.
+		std::array< Details::AliasTable< Capacity >, States > m_arrayTables {};
+
+		//! Statistics of each mutation.
+		std::array< MutationStatistics, Capacity > m_arrayStatistics {};
+
+		//! Mutations applied since the previous report.
+		std::array< bool, Capacity > m_arrayUsed {};
+
+		//! Number of mutations in the mutation table.
+		size_t m_sizeMutations = 0;
+
+		//! Number of reports between weight updates. Zero disables adaptation.
+		size_t m_sizeUpdateInterval = 0;
+
+		//! Number of reports since the previous weight update.
+		size_t m_sizeReports = 0;
+
+	public:
+
+		//! Creates a scheduler. Mutations without a configured weight have a weight of 1.
+		constexpr explicit WeightedScheduler(
+			std::span< const double > spanWeights = {},  //!< Weights indexed by the position of the mutation in the table.
+			size_t sizeUpdateInterval = 1024  //!< Number of reports between weight updates. Zero disables adaptation.
+		) :
+		m_sizeUpdateInterval { sizeUpdateInterval }
+		{
+			std::ranges::fill( m_arrayBaseWeights, 1.0 );
+			SetWeights( spanWeights );
+		}
+
+		//! Classifies the mutations of a mutation table.
+		template< std::ranges::contiguous_range Range >
+		constexpr void Initialize(
+			const Range& mutations  //!< Mutation table used by the engine.
+		)
+		{
+			m_sizeMutations = std::ranges::size( mutations );
+			m_eligible = Details::EligibleMutations< Capacity > { mutations };
+			Update();
+		}
+
+		//! Sets the configured weights and resets the feedback.
+		constexpr void SetWeights(
+			std::span< const double > spanWeights  //!< Weights indexed by the position of the mutation in the table.
+		)
+		{
+			assert( spanWeights.size() <= Capacity );
+			std::ranges::copy( spanWeights.subspan( 0, std::min( spanWeights.size(), Capacity ) ), m_arrayBaseWeights.begin() );
+			m_arrayStatistics = {};
+			m_arrayUsed = {};
+			m_sizeReports = 0;
+			Update();
+		}
+
+		//! Returns true if some mutation with non-zero weight is suitable for the size state.
+		constexpr bool CanSelect(
+			Details::SizeState state  //!< Size state of the value.
+		) const
+		{
+			return ! m_arrayTables[ static_cast< size_t >( state ) ].IsEmpty();
+		}
+
+		//! Selects the index of a suitable mutation.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		size_t Select(
+			Details::SizeState state,  //!< Size state of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			size_t index = m_arrayTables[ static_cast< size_t >( state ) ].Sample( generator );
+			m_arrayStatistics[ index ].ui64Selections++;
+			m_arrayUsed[ index ] = true;
+			return index;
+		}
+
+		//! Reports the result of executing the input mutated since the previous report.
+		constexpr void Report(
+			bool bNewCoverage  //!< True if the input found new coverage.
+		)
+		{
+			// Credit the mutations that were applied.
+			for( size_t i = 0; i < m_sizeMutations; i++ )
+			{
+				if( ! m_arrayUsed[ i ] )
+					continue;
+				m_arrayStatistics[ i ].ui64Rounds++;
+				if( bNewCoverage )
+					m_arrayStatistics[ i ].ui64Finds++;
+				m_arrayUsed[ i ] = false;
+			}
+
+			// Periodically adapt the weights.
+			if( m_sizeUpdateInterval > 0 && ++m_sizeReports >= m_sizeUpdateInterval )
+			{
+				m_sizeReports = 0;
+				Update();
+			}
+		}
+
+		//! Recalculates the weights from the feedback and rebuilds the alias tables.
+		constexpr void Update()
+		{
+			// Calculate the smoothed find rate of each mutation and their average.
+			std::array< double, Capacity > arrayRates {};
+			double dRateSum = 0;
+			size_t sizeWeighted = 0;
+			for( size_t i = 0; i < m_sizeMutations; i++ )
+			{
+				const MutationStatistics& statistics = m_arrayStatistics[ i ];
+				arrayRates[ i ] = ( statistics.ui64Finds + 1.0 ) / ( statistics.ui64Rounds + 1.0 );
+				if( m_arrayBaseWeights[ i ] > 0 )
+				{
+					dRateSum += arrayRates[ i ];
+					sizeWeighted++;
+				}
+			}
+
+			// Scale the configured weights by the relative find rates.
+			double dRateAverage = sizeWeighted > 0 ? dRateSum / sizeWeighted : 1.0;
+			for( size_t i = 0; i < m_sizeMutations; i++ )
+			{
+				double dFactor = std::clamp( arrayRates[ i ] / dRateAverage, MinimumFactor, MaximumFactor );
+				m_arrayWeights[ i ] = m_arrayBaseWeights[ i ] * dFactor;
+			}
+
+			// Rebuild the alias tables.
+			std::span< const double > spanWeights = std::span { m_arrayWeights }.subspan( 0, m_sizeMutations );
+			for( size_t state = 0; state < States; state++ )
+				m_arrayTables[ state ].Build( m_eligible.Get( static_cast< Details::SizeState >( state ) ), spanWeights );
+		}
+
+		//! Gets the weights currently used for sampling.
+		constexpr std::span< const double > GetWeights() const
+		{
+			return std::span { m_arrayWeights }.subspan( 0, m_sizeMutations );
+		}
+
+		//! Gets the statistics of each mutation.
+		constexpr std::span< const MutationStatistics > GetStatistics() const
+		{
+			return std::span { m_arrayStatistics }.subspan( 0, m_sizeMutations );
+		}
+	};
+}
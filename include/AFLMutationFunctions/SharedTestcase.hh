@@ -0,0 +1,130 @@
+/*! \file
+Havoc mutation directly into a shared-memory test case region of an AFL++-style forkserver.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Batch.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	View of a shared-memory test case region in the layout of AFL++: a 32-bit length in native byte order
+	followed by the bytes of the test case.
+
+	The bytes after the header are used as the buffer of the mutations, so a mutant is produced in place and
+	does not have to be copied to the region. The length is written with a release store after the mutant,
+	so a target that reads the length with an acquire load sees the whole mutant. The region must be aligned
+	for a 32-bit atomic, which page-aligned shared memory always is.
+	*/
+	class SharedTestcase
+	{
+	public:
+
+		//! Size of the length header at the beginning of the region.
+		static constexpr size_t HeaderSize = sizeof( uint32_t );
+
+	private:
+
+		//! Length header of the region.
+		uint32_t* m_pLength = nullptr;
+
+		//! Bytes of the test case after the header.
+		std::span< std::byte > m_spanBuffer;
+
+	public:
+
+		//! Creates a view of a region. The current length in the header is kept.
+		explicit SharedTestcase(
+			std::span< std::byte > spanRegion  //!< Whole shared-memory region including the header.
+		) :
+		m_pLength { reinterpret_cast< uint32_t* >( spanRegion.data() ) },
+		m_spanBuffer { spanRegion.subspan( std::min( HeaderSize, spanRegion.size() ) ) }
+		{
+			assert( spanRegion.size() > HeaderSize );
+			assert( reinterpret_cast< uintptr_t >( spanRegion.data() ) % std::atomic_ref< uint32_t >::required_alignment == 0 );
+			m_spanBuffer = m_spanBuffer.first( std::min< size_t >( m_spanBuffer.size(), std::numeric_limits< uint32_t >::max() ) );
+		}
+
+		//! Gets the largest test case the region can hold.
+		size_t Capacity() const
+		{
+			return m_spanBuffer.size();
+		}
+
+		//! Gets the bytes of the region after the header, used as the buffer of the mutations.
+		std::span< std::byte > GetBuffer() const
+		{
+			return m_spanBuffer;
+		}
+
+		//! Gets the length in the header.
+		size_t GetSize() const
+		{
+			return std::atomic_ref< uint32_t > { *m_pLength }.load( std::memory_order_acquire );
+		}
+
+		//! Gets the current test case.
+		std::span< std::byte > GetValue() const
+		{
+			return m_spanBuffer.first( std::min( GetSize(), Capacity() ) );
+		}
+
+		//! Writes the length to the header after the bytes of the test case were written.
+		void SetSize(
+			size_t size  //!< Length of the test case. Must fit in the region.
+		)
+		{
+			assert( size <= Capacity() );
+			std::atomic_ref< uint32_t > { *m_pLength }.store( static_cast< uint32_t >( size ), std::memory_order_release );
+		}
+
+		//! Copies a test case to the region and writes its length. Bytes that do not fit are dropped.
+		std::span< std::byte > Assign(
+			std::span< const std::byte > spanValue  //!< Test case that is written.
+		)
+		{
+			size_t size = std::min( spanValue.size(), Capacity() );
+			std::ranges::copy( spanValue.first( size ), m_spanBuffer.begin() );
+			SetSize( size );
+			return m_spanBuffer.first( size );
+		}
+
+		//! Applies a round of havoc mutations in place to the test case in the region and writes the new length.
+		template< class Engine, class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > && HavocMutator< Engine, Gen >
+		std::span< std::byte > Havoc(
+			Engine& engine,  //!< Havoc mutator that is applied to the test case.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			std::span< std::byte > spanMutant = engine( m_spanBuffer, std::min( GetSize(), Capacity() ), generator );
+			SetSize( spanMutant.size() );
+			return spanMutant;
+		}
+
+		//! Copies a seed to the region, mutates it in place and writes the length of the mutant.
+		template< class Engine, class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > && HavocMutator< Engine, Gen >
+		std::span< std::byte > Havoc(
+			Engine& engine,  //!< Havoc mutator that is applied to the seed.
+			std::span< const std::byte > spanSeed,  //!< Seed that is mutated.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			size_t sizeSeed = std::min( spanSeed.size(), Capacity() );
+			std::ranges::copy( spanSeed.first( sizeSeed ), m_spanBuffer.begin() );
+			std::span< std::byte > spanMutant = engine( m_spanBuffer, sizeSeed, generator );
+			SetSize( spanMutant.size() );
+			return spanMutant;
+		}
+	};
+}
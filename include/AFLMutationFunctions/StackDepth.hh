@@ -0,0 +1,101 @@
+/*! \file
+Policies that draw the number of mutations stacked in a round of havoc.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <random>
+
+#include "AFLMutationFunctions/Details.hh"
+#include "AFLMutationFunctions/Random.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Concept for a compile-time policy that draws the number of mutations of a round from the size of the value.
+	template< class Depth, class Gen >
+	concept StackDepthPolicy = requires( size_t sizeValue, Gen& generator ) {
+		{
+			Depth::Draw( sizeValue, generator )
+		} -> std::convertible_to< unsigned int >;
+	};
+
+	//! Draws a power of two from 1 to 2^MaxIterationsPower, each with the same probability.
+	template< unsigned int MaxIterationsPower = 5 >
+		requires( MaxIterationsPower < 32 )
+	struct PowerOfTwoDepth
+	{
+		//! Draws the number of mutations of a round.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		static constexpr unsigned int Draw(
+			size_t,  //!< Size of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			return 1u << Details::RandomInRange( 0u, MaxIterationsPower, generator );
+		}
+	};
+
+	//! Draws the stack depth of AFL, 1 << ( 1 + rand( StackPower ) ), from 2 to 2^StackPower.
+	template< unsigned int StackPower = 7 >
+		requires ( StackPower > 0 && StackPower < 32 )
+	struct AFLStackDepth
+	{
+		//! Draws the number of mutations of a round.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		static constexpr unsigned int Draw(
+			size_t,  //!< Size of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			return 1u << ( 1 + Details::RandomInRange( 0u, StackPower - 1, generator ) );
+		}
+	};
+
+	//! Applies the same number of mutations in every round.
+	template< unsigned int Iterations >
+	struct FixedDepth
+	{
+		//! Gets the number of mutations of a round without drawing.
+		template< class Gen >
+		static constexpr unsigned int Draw(
+			size_t,  //!< Size of the value.
+			Gen&  //!< Random number generator that is not used.
+		)
+		{
+			return Iterations;
+		}
+	};
+
+	/*!
+	Draws the stack depth of AFL for small values and halves the largest depth every time a large value doubles.
+
+	Values smaller than LargeSize use the depths of AFLStackDepth< StackPower >. Every doubling of the value
+	from LargeSize removes the largest power, so a value of LargeSize << ( StackPower - 1 ) bytes or more
+	gets a single mutation. Deep stacks on large values mostly move bytes around.
+	*/
+	template< unsigned int StackPower = 7, size_t LargeSize = 64 << 10 >
+		requires ( StackPower > 0 && StackPower < 32 && LargeSize > 0 )
+	struct AdaptiveDepth
+	{
+		//! Draws the number of mutations of a round.
+		template< class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > >
+		static constexpr unsigned int Draw(
+			size_t sizeValue,  //!< Size of the value.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			// Remove one power for every doubling of the value beyond the large size.
+			unsigned int uiPower = StackPower - std::min< unsigned int >( StackPower, std::bit_width( sizeValue / LargeSize ) );
+			if( uiPower == 0 )
+				return 1;
+			return 1u << ( 1 + Details::RandomInRange( 0u, uiPower - 1, generator ) );
+		}
+	};
+}
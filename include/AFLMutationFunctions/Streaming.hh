@@ -0,0 +1,211 @@
+/*! \file
+Havoc over windows of large values that are streamed to the target without being loaded whole.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#if ! defined( _WIN32 )
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Batch.hh"
+#include "AFLMutationFunctions/Corpus.hh"
+
+namespace AFLMutationFunctions
+{
+	//! Window of a value that is replaced by its mutant.
+	struct StreamWindow
+	{
+		size_t sizeOffset = 0;  //!< Offset of the window in the value.
+		size_t sizeOriginal = 0;  //!< Number of bytes of the value replaced by the mutant.
+		std::span< const byte > spanMutant;  //!< Mutated bytes of the window.
+	};
+
+	/*!
+	Applies havoc to a few windows of a large value and describes the mutant as a list of segments.
+
+	The value is typically a MappedFile. Only the windows are copied to the working memory, which is
+	allocated when the object is constructed and holds every window with room to grow. The mutant is the
+	untouched ranges of the value interleaved with the mutated windows, so it can be written with a single
+	gather write such as WriteSegments. The windows are drawn from equal strata of the value, so they never
+	overlap, and the mutations cannot move bytes across the edges of a window.
+	*/
+	class StreamingHavoc
+	{
+	private:
+
+		//! Size of a window.
+		size_t m_sizeWindow = 0;
+
+		//! Size of a window with room to grow.
+		size_t m_sizeCapacity = 0;
+
+		//! Largest number of windows mutated at once.
+		size_t m_sizeMaxWindows = 0;
+
+		//! Working memory of the windows.
+		MutantArena m_arena;
+
+		//! Windows of the latest mutant.
+		std::vector< StreamWindow > m_vecWindows;
+
+		//! Segments of the latest mutant.
+		std::vector< std::span< const byte > > m_vecSegments;
+
+		//! Size of the latest mutant.
+		size_t m_sizeMutant = 0;
+
+	public:
+
+		//! Allocates the working memory.
+		StreamingHavoc(
+			size_t sizeWindow,  //!< Number of bytes of the value in a window.
+			size_t sizeGrowth,  //!< Number of bytes a window can grow. Must not be zero.
+			size_t sizeMaxWindows  //!< Largest number of windows mutated at once. Must not be zero.
+		) :
+		m_sizeWindow { sizeWindow },
+		m_sizeCapacity { sizeWindow + sizeGrowth },
+		m_sizeMaxWindows { sizeMaxWindows },
+		m_arena { sizeWindow + sizeGrowth, sizeMaxWindows }
+		{
+			assert( sizeGrowth > 0 && sizeMaxWindows > 0 );
+			m_vecWindows.reserve( sizeMaxWindows );
+			m_vecSegments.reserve( sizeMaxWindows * 2 + 1 );
+		}
+
+		//! Gets the largest number of windows mutated at once.
+		size_t MaxWindows() const
+		{
+			return m_sizeMaxWindows;
+		}
+
+		/*!
+		Mutates a random number of windows of a value and gets the segments of the mutant.
+
+		The segments refer to the value and to the working memory, so they stay valid until the next mutant
+		while the value is alive.
+		*/
+		template< class Engine, class Gen >
+			requires std::uniform_random_bit_generator< std::remove_reference_t< Gen > > && HavocMutator< Engine, Gen >
+		std::span< const std::span< const byte > > Mutate(
+			Engine& engine,  //!< Havoc mutator that is applied to every window.
+			std::span< const byte > spanValue,  //!< Value that is mutated.
+			Gen& generator  //!< Random number generator used as the source of randomness.
+		)
+		{
+			// Split the value to strata with one window each.
+			m_vecWindows.clear();
+			m_vecSegments.clear();
+			size_t sizeWindows = Details::RandomInRange< size_t >( 1, std::min( MaxWindows(), std::max< size_t >( spanValue.size(), 1 ) ), generator );
+			size_t sizeStratum = spanValue.size() / sizeWindows;
+
+			size_t sizeCopied = 0;
+			m_sizeMutant = spanValue.size();
+			for( size_t i = 0; i < sizeWindows; i++ )
+			{
+				// Draw the window within its stratum.
+				size_t sizeBegin = i * sizeStratum;
+				size_t sizeEnd = i + 1 == sizeWindows ? spanValue.size() : sizeBegin + sizeStratum;
+				size_t sizeOriginal = std::min( m_sizeWindow, sizeEnd - sizeBegin );
+				size_t sizeOffset = sizeBegin + Details::RandomInRange< size_t >( 0, sizeEnd - sizeBegin - sizeOriginal, generator );
+
+				// Mutate a copy of the window in its slot.
+				std::span< byte > spanSlot = m_arena.GetArena().subspan( i * GetBatchStride( m_sizeCapacity ), m_sizeCapacity );
+				std::ranges::copy( spanValue.subspan( sizeOffset, sizeOriginal ), spanSlot.begin() );
+				std::span< byte > spanMutant = engine( spanSlot, sizeOriginal, generator );
+				m_vecWindows.push_back( StreamWindow { sizeOffset, sizeOriginal, spanMutant } );
+				m_sizeMutant = m_sizeMutant - sizeOriginal + spanMutant.size();
+
+				// Interleave the untouched range before the window with the window.
+				AddSegment( spanValue.subspan( sizeCopied, sizeOffset - sizeCopied ) );
+				AddSegment( spanMutant );
+				sizeCopied = sizeOffset + sizeOriginal;
+			}
+			AddSegment( spanValue.subspan( sizeCopied ) );
+			return m_vecSegments;
+		}
+
+		//! Gets the windows of the latest mutant in the order of their offsets.
+		std::span< const StreamWindow > GetWindows() const
+		{
+			return m_vecWindows;
+		}
+
+		//! Gets the segments of the latest mutant.
+		std::span< const std::span< const byte > > GetSegments() const
+		{
+			return m_vecSegments;
+		}
+
+		//! Gets the size of the latest mutant.
+		size_t Size() const
+		{
+			return m_sizeMutant;
+		}
+
+	private:
+
+		//! Adds a segment to the mutant unless it is empty.
+		void AddSegment(
+			std::span< const byte > spanSegment  //!< Bytes of the segment.
+		)
+		{
+			if( ! spanSegment.empty() )
+				m_vecSegments.push_back( spanSegment );
+		}
+	};
+
+#if ! defined( _WIN32 )
+	/*!
+	Writes a list of segments to a file descriptor with gather writes.
+
+	Partial writes and interrupted calls are resumed. Returns false if a write fails.
+	*/
+	inline bool WriteSegments(
+		int fd,  //!< File descriptor the segments are written to, such as a pipe to the target.
+		std::span< const std::span< const byte > > spanSegments  //!< Segments that are written in order.
+	)
+	{
+		// Write up to IOV_MAX segments with every call.
+		constexpr size_t IovecBatch = std::min< size_t >( IOV_MAX, 64 );
+		std::array< iovec, IovecBatch > arrayIovecs {};
+		size_t sizeSegment = 0;
+		size_t sizeSkipped = 0;
+		while( sizeSegment < spanSegments.size() )
+		{
+			// Describe the next segments, starting from the unwritten part of the first one.
+			size_t sizeIovecs = std::min( IovecBatch, spanSegments.size() - sizeSegment );
+			for( size_t i = 0; i < sizeIovecs; i++ )
+			{
+				std::span< const byte > spanSegment = spanSegments[ sizeSegment + i ].subspan( i == 0 ? sizeSkipped : 0 );
+				arrayIovecs[ i ] = iovec { const_cast< byte* >( spanSegment.data() ), spanSegment.size() };
+			}
+			ssize_t sizeWritten = writev( fd, arrayIovecs.data(), static_cast< int >( sizeIovecs ) );
+			if( sizeWritten < 0 )
+			{
+				if( errno == EINTR )
+					continue;
+				return false;
+			}
+
+			// Skip the segments that were written completely.
+			size_t sizeLeft = static_cast< size_t >( sizeWritten ) + sizeSkipped;
+			while( sizeSegment < spanSegments.size() && sizeLeft >= spanSegments[ sizeSegment ].size() )
+				sizeLeft -= spanSegments[ sizeSegment++ ].size();
+			sizeSkipped = sizeLeft;
+		}
+		return true;
+	}
+#endif
+}
@@ -0,0 +1,371 @@
+/*! \file
+Compact traces of havoc rounds that can be replayed without a random number generator.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Fixed-capacity record of the steps of a havoc round.
+
+	Every step stores the index of the applied mutation and the bounded draws the mutation made,
+	which are its offsets, sizes and values. When the trace runs out of capacity, recording stops and
+	the trace keeps the complete steps recorded so far.
+	*/
+	template< size_t MaxSteps = 64, size_t MaxDraws = 512 >
+		requires( MaxDraws <= std::numeric_limits< uint16_t >::max() )
+	class MutationTrace
+	{
+	private:
+
+		//! Location of the draws of a step.
+		struct Step
+		{
+			uint8_t ui8Mutation = 0;  //!< Index of the mutation in the table.
+			uint16_t ui16FirstDraw = 0;  //!< Index of the first draw of the step.
+			uint16_t ui16Draws = 0;  //!< Number of draws of the step.
+		};
+
+		//! Recorded steps.
+		std::array< Step, MaxSteps > m_arraySteps {};
+
+		//! Number of recorded steps.
+		size_t m_sizeSteps = 0;
+
+		//! Recorded draws of all steps.
+		std::array< uint64_t, MaxDraws > m_arrayDraws {};
+
+		//! Number of recorded draws.
+		size_t m_sizeDraws = 0;
+
+		//! Whether a step is being recorded.
+		bool m_bOpen = false;
+
+		//! Whether a step did not fit.
+		bool m_bOverflow = false;
+
+	public:
+
+		//! Removes every step.
+		constexpr void Clear()
+		{
+			m_sizeSteps = 0;
+			m_sizeDraws = 0;
+			m_bOpen = false;
+			m_bOverflow = false;
+		}
+
+		//! Starts recording a step.
+		constexpr void BeginStep(
+			size_t index  //!< Index of the mutation in the table.
+		)
+		{
+			assert( ! m_bOpen );
+			assert( index <= std::numeric_limits< uint8_t >::max() );
+			if( m_bOverflow || m_sizeSteps == MaxSteps )
+			{
+				m_bOverflow = true;
+				return;
+			}
+			m_arraySteps[ m_sizeSteps ] = Step { static_cast< uint8_t >( index ), static_cast< uint16_t >( m_sizeDraws ), 0 };
+			m_bOpen = true;
+		}
+
+		//! Records a draw of the current step. Draws outside of steps are not recorded.
+		constexpr void Record(
+			uint64_t ui64Draw  //!< Value that was drawn.
+		)
+		{
+			if( ! m_bOpen )
+				return;
+
+			// A step that does not fit is dropped with every later step.
+			if( m_sizeDraws == MaxDraws )
+			{
+				m_sizeDraws = m_arraySteps[ m_sizeSteps ].ui16FirstDraw;
+				m_bOpen = false;
+				m_bOverflow = true;
+				return;
+			}
+			m_arrayDraws[ m_sizeDraws++ ] = ui64Draw;
+			m_arraySteps[ m_sizeSteps ].ui16Draws++;
+		}
+
+		//! Finishes recording the current step.
+		constexpr void EndStep()
+		{
+			if( ! m_bOpen )
+				return;
+			m_sizeSteps++;
+			m_bOpen = false;
+		}
+
+		//! Removes a step and its draws.
+		constexpr void RemoveStep(
+			size_t index  //!< Index of the step.
+		)
+		{
+			assert( index < m_sizeSteps && ! m_bOpen );
+			Step step = m_arraySteps[ index ];
+			std::copy( m_arrayDraws.begin() + step.ui16FirstDraw + step.ui16Draws,
+					m_arrayDraws.begin() + m_sizeDraws, m_arrayDraws.begin() + step.ui16FirstDraw );
+			m_sizeDraws -= step.ui16Draws;
+			std::copy( m_arraySteps.begin() + index + 1, m_arraySteps.begin() + m_sizeSteps, m_arraySteps.begin() + index );
+			m_sizeSteps--;
+			for( size_t i = index; i < m_sizeSteps; i++ )
+				m_arraySteps[ i ].ui16FirstDraw -= step.ui16Draws;
+		}
+
+		//! Gets the number of recorded steps.
+		constexpr size_t Size() const
+		{
+			return m_sizeSteps;
+		}
+
+		//! Gets whether every step of the round was recorded.
+		constexpr bool IsComplete() const
+		{
+			return ! m_bOverflow;
+		}
+
+		//! Gets the index of the mutation applied in a step.
+		constexpr size_t GetMutation(
+			size_t index  //!< Index of the step.
+		) const
+		{
+			assert( index < m_sizeSteps );
+			return m_arraySteps[ index ].ui8Mutation;
+		}
+
+		//! Gets the draws made in a step.
+		constexpr std::span< const uint64_t > GetDraws(
+			size_t index  //!< Index of the step.
+		) const
+		{
+			assert( index < m_sizeSteps );
+			const Step& step = m_arraySteps[ index ];
+			return std::span { m_arrayDraws }.subspan( step.ui16FirstDraw, step.ui16Draws );
+		}
+	};
+
+	/*!
+	Random bit generator adaptor that records the steps of havoc rounds.
+
+	Bounded draws are forwarded to the base generator and recorded while a step is open.
+	Havoc opens and closes the steps, and every round replaces the previous trace.
+	*/
+	template< class Gen, size_t MaxSteps = 64, size_t MaxDraws = 512 >
+		requires std::uniform_random_bit_generator< Gen >
+	class TraceGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		using Details::GeneratorAdaptor< Gen >::m_generator;
+
+		//! Trace of the latest round.
+		MutationTrace< MaxSteps, MaxDraws > m_trace;
+
+	public:
+
+		//! Creates a tracer with a default-constructed base generator.
+		constexpr TraceGenerator() = default;
+
+		//! Creates a tracer from a base generator.
+		constexpr explicit TraceGenerator(
+			Gen generator  //!< Generator that provides the randomness.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) }
+		{
+		}
+
+		//! Draws a uniformly distributed integer in range [low, high] from the base generator and records it.
+		constexpr uint64_t Uniform(
+			uint64_t low,  //!< Smallest possible value.
+			uint64_t high  //!< Largest possible value.
+		)
+		{
+			uint64_t ui64Draw = Details::RandomInRange( low, high, m_generator );
+			m_trace.Record( ui64Draw );
+			return ui64Draw;
+		}
+
+		//! Draws the offset of a position from the base generator and records it, so it is replayed as a uniform draw.
+		constexpr size_t DrawOffset(
+			size_t sizeMax  //!< Largest possible offset.
+		)
+			requires Details::OffsetSource< Gen >
+		{
+			size_t sizeOffset = m_generator.DrawOffset( sizeMax );
+			m_trace.Record( sizeOffset );
+			return sizeOffset;
+		}
+
+		//! Starts a new trace.
+		constexpr void BeginRound()
+		{
+			Details::NotifyBeginRound( m_generator );
+			m_trace.Clear();
+		}
+
+		//! Starts recording a step.
+		constexpr void BeginStep(
+			size_t index  //!< Index of the mutation in the table.
+		)
+		{
+			Details::NotifyBeginStep( m_generator, index );
+			m_trace.BeginStep( index );
+		}
+
+		//! Finishes recording a step.
+		constexpr void EndStep()
+		{
+			Details::NotifyEndStep( m_generator );
+			m_trace.EndStep();
+		}
+
+		//! Gets the trace of the latest round.
+		constexpr const MutationTrace< MaxSteps, MaxDraws >& GetTrace() const
+		{
+			return m_trace;
+		}
+	};
+
+	/*!
+	Random bit generator that serves recorded draws.
+
+	Every bounded draw is clamped to the requested range, so draws stay valid when earlier steps of a trace
+	were removed. Draws past the end of the recording return the smallest possible value. Unbounded draws return zero.
+	*/
+	class ReplayGenerator
+	{
+	public:
+
+		//! Type of the generated values.
+		using result_type = uint64_t;
+
+	private:
+
+		//! Draws that are served.
+		std::span< const uint64_t > m_spanDraws;
+
+		//! Index of the next draw.
+		size_t m_sizeNext = 0;
+
+	public:
+
+		//! Creates a generator that serves the draws of a step.
+		constexpr explicit ReplayGenerator(
+			std::span< const uint64_t > spanDraws  //!< Draws that are served.
+		) :
+		m_spanDraws { spanDraws }
+		{
+		}
+
+		//! Gets the smallest value the generator produces.
+		static constexpr result_type min()
+		{
+			return std::numeric_limits< result_type >::min();
+		}
+
+		//! Gets the largest value the generator produces.
+		static constexpr result_type max()
+		{
+			return std::numeric_limits< result_type >::max();
+		}
+
+		//! Returns zero.
+		constexpr result_type operator()()
+		{
+			return 0;
+		}
+
+		//! Serves the next recorded draw clamped to the range [low, high].
+		constexpr uint64_t Uniform(
+			uint64_t low,  //!< Smallest possible value.
+			uint64_t high  //!< Largest possible value.
+		)
+		{
+			if( m_sizeNext == m_spanDraws.size() )
+				return low;
+			return std::clamp( m_spanDraws[ m_sizeNext++ ], low, high );
+		}
+	};
+
+	namespace Details
+	{
+		//! Applies the steps of a trace whose mutations are eligible for the value size.
+		template< size_t MaxSteps, size_t MaxDraws, size_t Capacity >
+		std::span< std::byte > ReplayTrace(
+			std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+			size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+			const MutationTrace< MaxSteps, MaxDraws >& trace,  //!< Trace that is replayed.
+			std::span< const MutationFunction< ReplayGenerator > > spanMutations,  //!< Table the trace was recorded with.
+			const EligibleMutations< Capacity >& eligible  //!< Suitable mutations of the table for each size state.
+		)
+		{
+			// Nothing can be mutated in an empty buffer.
+			sizeValue = std::min( sizeValue, spanBuffer.size() );
+			std::span< byte > spanValue { spanBuffer.subspan( 0, sizeValue ) };
+			if( spanBuffer.empty() )
+				return spanValue;
+
+			// Apply every step that is still suitable.
+			for( size_t i = 0; i < trace.Size(); i++ )
+			{
+				size_t index = trace.GetMutation( i );
+				std::span< const uint8_t > spanEligible = eligible.Get( GetSizeState( spanBuffer.size(), spanValue.size() ) );
+				if( std::ranges::find( spanEligible, index ) == spanEligible.end() )
+					continue;
+
+				ReplayGenerator generator { trace.GetDraws( i ) };
+				spanValue = spanMutations[ index ]( spanBuffer, spanValue.size(), generator );
+			}
+
+			return spanValue;
+		}
+	}
+
+	/*!
+	Applies the steps of a trace in place without drawing random numbers.
+
+	The table must be the one the trace was recorded with. Replaying the trace on the value it was recorded on
+	reproduces the mutant. Steps whose mutation is not suitable for the current value size are skipped.
+	*/
+	template< size_t MaxSteps, size_t MaxDraws >
+	std::span< std::byte > ReplayHavoc(
+		std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		const MutationTrace< MaxSteps, MaxDraws >& trace,  //!< Trace that is replayed.
+		std::span< const Details::MutationFunction< ReplayGenerator > > spanMutations  //!< Table the trace was recorded with.
+	)
+	{
+		assert( spanMutations.size() <= HavocEngine< ReplayGenerator >::MaxMutations );
+		Details::EligibleMutations< HavocEngine< ReplayGenerator >::MaxMutations > eligible { spanMutations };
+		return Details::ReplayTrace( spanBuffer, sizeValue, trace, spanMutations, eligible );
+	}
+
+	//! Applies the steps of a trace recorded with the default mutations in place without drawing random numbers.
+	template< size_t MaxSteps, size_t MaxDraws >
+	std::span< std::byte > ReplayHavoc(
+		std::span< std::byte > spanBuffer,  //!< Buffer containing the data that is mutated.
+		size_t sizeValue,  //!< Bounds of the value currently contained in buffer.
+		const MutationTrace< MaxSteps, MaxDraws >& trace  //!< Trace that is replayed.
+	)
+	{
+		// The table is classified at compile-time.
+		static constexpr auto arrayTable = GetMutationTable< ReplayGenerator >();
+		static constexpr Details::EligibleMutations< arrayTable.size() > eligible { arrayTable };
+		return Details::ReplayTrace( spanBuffer, sizeValue, trace, std::span { arrayTable }, eligible );
+	}
+}
@@ -0,0 +1,239 @@
+/*! \file
+Undo journal that reverts havoc rounds applied in place.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "AFLMutationFunctions.hh"
+
+namespace AFLMutationFunctions
+{
+	/*!
+	Journal of the original bytes of every region overwritten or shifted by mutations.
+
+	Overwritten bytes are saved to an arena allocated when the journal is constructed. Moves are journaled as
+	moves, and only the destination bytes that the source does not cover are saved, so reverting a shift costs
+	the same as applying it. If the arena or the entry table runs out of space, the journal stops saving and
+	can no longer revert.
+	*/
+	class UndoJournal
+	{
+	private:
+
+		//! Location of a saved region or a move.
+		struct Entry
+		{
+			size_t sizeOffset = 0;  //!< Offset of the region or the move destination from the beginning of the buffer.
+			size_t size = 0;  //!< Size of the region or the number of moved bytes.
+			size_t sizeSource = 0;  //!< Offset of the saved bytes in the arena or the move source in the buffer.
+			bool bMove = false;  //!< Whether the entry is a move.
+		};
+
+		//! Storage of the saved bytes.
+		std::unique_ptr< std::byte[] > m_pArena;
+
+		//! Size of the arena.
+		size_t m_sizeArena = 0;
+
+		//! Number of bytes used in the arena.
+		size_t m_sizeUsed = 0;
+
+		//! Storage of the entries.
+		std::unique_ptr< Entry[] > m_pEntries;
+
+		//! Maximum number of entries.
+		size_t m_sizeMaxEntries = 0;
+
+		//! Number of entries.
+		size_t m_sizeEntries = 0;
+
+		//! Whether a region did not fit.
+		bool m_bOverflow = false;
+
+	public:
+
+		//! Allocates a journal.
+		explicit UndoJournal(
+			size_t sizeArena,  //!< Maximum number of bytes saved.
+			size_t sizeMaxEntries = 256  //!< Maximum number of saved regions.
+		) :
+		m_pArena { std::make_unique_for_overwrite< std::byte[] >( sizeArena ) },
+		m_sizeArena { sizeArena },
+		m_pEntries { std::make_unique< Entry[] >( sizeMaxEntries ) },
+		m_sizeMaxEntries { sizeMaxEntries }
+		{
+		}
+
+		//! Saves the bytes of a region before they are written.
+		void Save(
+			std::span< const std::byte > spanBuffer,  //!< Buffer containing the region.
+			size_t sizeOffset,  //!< Offset of the region from the beginning of the buffer.
+			size_t size  //!< Size of the region.
+		)
+		{
+			assert( sizeOffset + size <= spanBuffer.size() );
+			if( m_bOverflow || size == 0 )
+				return;
+			if( m_sizeEntries == m_sizeMaxEntries || size > m_sizeArena - m_sizeUsed )
+			{
+				m_bOverflow = true;
+				return;
+			}
+
+			Details::MoveBytes( m_pArena.get() + m_sizeUsed, spanBuffer.data() + sizeOffset, size );
+			m_pEntries[ m_sizeEntries++ ] = Entry { sizeOffset, size, m_sizeUsed, false };
+			m_sizeUsed += size;
+		}
+
+		//! Journals a move before it is applied.
+		void SaveMove(
+			std::span< const std::byte > spanBuffer,  //!< Buffer containing the bytes.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+			size_t size  //!< Number of moved bytes.
+		)
+		{
+			// Save the destination bytes outside of the source.
+			if( sizeDestination > sizeSource )
+			{
+				size_t sizeLost = std::max( sizeSource + size, sizeDestination );
+				Save( spanBuffer, sizeLost, sizeDestination + size - sizeLost );
+			}
+			else
+			{
+				Save( spanBuffer, sizeDestination, std::min( sizeDestination + size, sizeSource ) - sizeDestination );
+			}
+
+			if( m_bOverflow || size == 0 || sizeDestination == sizeSource )
+				return;
+			if( m_sizeEntries == m_sizeMaxEntries )
+			{
+				m_bOverflow = true;
+				return;
+			}
+			m_pEntries[ m_sizeEntries++ ] = Entry { sizeDestination, size, sizeSource, true };
+		}
+
+		/*!
+		Restores every saved region in reverse order and clears the journal.
+
+		Returns false without modifying the buffer if some region could not be saved.
+		*/
+		bool Revert(
+			std::span< std::byte > spanBuffer  //!< Buffer the regions were saved from.
+		)
+		{
+			bool bComplete = ! m_bOverflow;
+			if( bComplete )
+			{
+				for( size_t i = m_sizeEntries; i-- > 0; )
+				{
+					const Entry& entry = m_pEntries[ i ];
+					assert( entry.sizeOffset + entry.size <= spanBuffer.size() );
+					if( entry.bMove )
+						Details::MoveBytes( spanBuffer.data() + entry.sizeSource, spanBuffer.data() + entry.sizeOffset, entry.size );
+					else
+						Details::MoveBytes( spanBuffer.data() + entry.sizeOffset, m_pArena.get() + entry.sizeSource, entry.size );
+				}
+			}
+			Clear();
+			return bComplete;
+		}
+
+		//! Forgets every saved region.
+		void Clear()
+		{
+			m_sizeUsed = 0;
+			m_sizeEntries = 0;
+			m_bOverflow = false;
+		}
+
+		//! Gets the number of saved bytes.
+		size_t GetBytesSaved() const
+		{
+			return m_sizeUsed;
+		}
+
+		//! Gets whether every region was saved.
+		bool IsComplete() const
+		{
+			return ! m_bOverflow;
+		}
+	};
+
+	/*!
+	Random bit generator adaptor that saves every region the mutations write to an undo journal.
+
+	The journal accumulates over havoc rounds until it is reverted or cleared, so several rounds can be
+	reverted at once. Offsets are relative to the buffer passed to havoc.
+	*/
+	template< class Gen >
+		requires std::uniform_random_bit_generator< Gen >
+	class UndoGenerator : public Details::GeneratorAdaptor< Gen >
+	{
+	private:
+
+		using Details::GeneratorAdaptor< Gen >::m_generator;
+
+		//! Journal of the written regions.
+		UndoJournal m_journal;
+
+	public:
+
+		//! Creates a journaling generator from a base generator.
+		UndoGenerator(
+			Gen generator,  //!< Generator that provides the randomness.
+			size_t sizeArena,  //!< Maximum number of bytes saved.
+			size_t sizeMaxEntries = 256  //!< Maximum number of saved regions.
+		) :
+		Details::GeneratorAdaptor< Gen > { std::move( generator ) },
+		m_journal { sizeArena, sizeMaxEntries }
+		{
+		}
+
+		//! Saves a region before it is written.
+		void OnWrite(
+			std::span< const std::byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeOffset,  //!< Offset of the first written byte from the beginning of the buffer.
+			size_t size,  //!< Number of written bytes.
+			bool bResize  //!< Whether the write is part of a shift that changes the size of the value.
+		)
+		{
+			Details::NotifyWrite( m_generator, spanBuffer, sizeOffset, size, bResize );
+			m_journal.Save( spanBuffer, sizeOffset, size );
+		}
+
+		//! Journals a move before it is applied.
+		void OnMove(
+			std::span< const std::byte > spanBuffer,  //!< Buffer passed to the mutation.
+			size_t sizeDestination,  //!< Offset of the destination from the beginning of the buffer.
+			size_t sizeSource,  //!< Offset of the source from the beginning of the buffer.
+			size_t size  //!< Number of moved bytes.
+		)
+		{
+			Details::NotifyMove( m_generator, spanBuffer, sizeDestination, sizeSource, size );
+			m_journal.SaveMove( spanBuffer, sizeDestination, sizeSource, size );
+		}
+
+		//! Restores the buffer to its state before the journaled rounds. Returns false if the journal overflowed.
+		bool Revert(
+			std::span< std::byte > spanBuffer  //!< Buffer that was mutated.
+		)
+		{
+			return m_journal.Revert( spanBuffer );
+		}
+
+		//! Gets the journal.
+		UndoJournal& GetJournal()
+		{
+			return m_journal;
+		}
+	};
+}
@@ -0,0 +1,42 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// The allocation functions are replaced in their own translation unit, so they are not inlined to the tests
+// where compilers cannot match the allocations to the deallocations.
+
+//! Number of heap allocations made by the test program.
+size_t g_sizeAllocations = 0;
+
+void* operator new( size_t size )
+{
+	g_sizeAllocations++;
+	if( void* p = std::malloc( size ) )
+		return p;
+	throw std::bad_alloc {};
+}
+
+void* operator new[]( size_t size )
+{
+	return operator new( size );
+}
+
+void operator delete( void* p ) noexcept
+{
+	std::free( p );
+}
+
+void operator delete( void* p, size_t ) noexcept
+{
+	std::free( p );
+}
+
+void operator delete[]( void* p ) noexcept
+{
+	std::free( p );
+}
+
+void operator delete[]( void* p, size_t ) noexcept
+{
+	std::free( p );
+}
\ No newline at end of file
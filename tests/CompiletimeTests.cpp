@@ -1,6 +1,16 @@
 #include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Corpus.hh"
+#include "AFLMutationFunctions/Dictionary.hh"
+#include "AFLMutationFunctions/DirtyRanges.hh"
+#include "AFLMutationFunctions/Effective.hh"
+#include "AFLMutationFunctions/HotRegions.hh"
+#include "AFLMutationFunctions/PieceTable.hh"
+#include "AFLMutationFunctions/Trace.hh"
+#include "AFLMutationFunctions/Undo.hh"
 #include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <type_traits>
 
 using namespace AFLMutationFunctions;
 using namespace AFLMutationFunctions::Details;
@@ -39,6 +49,22 @@ static_assert( MaxIntWithSize( 9 ) == 0xffff );
 static_assert( MaxIntWithSize( 18 ) == 0xffffffff );
 static_assert( MaxIntWithSize( 33 ) == 0xffffffffffffffff );
 
+// Test the interesting integers of each width.
+static_assert( GetInterestingCountsByWidth()[ 0 ] == 0 && GetInterestingCountsByWidth()[ 8 ] == GetInterestingArray().size() );
+static_assert( GetInterestingArray()[ GetInterestingCountsByWidth()[ 1 ] - 1 ] == 0xff );
+static_assert( GetInterestingArray()[ GetInterestingCountsByWidth()[ 2 ] ] > 0xffff );
+static_assert( std::ranges::is_sorted( GetInterestingCountsByWidth() ) );
+
+// Test the interesting tables extended with extra integers.
+constexpr auto tableMagic = MakeInterestingTable< std::array< uint16_t, 2 > { 0x4d5a, 1500 }, std::array< int32_t, 1 > { -2 } >();
+static_assert( std::ranges::equal( DefaultInterestingTable.arrayValues, GetInterestingArray() ) );
+static_assert( std::ranges::is_sorted( tableMagic.arrayValues ) && std::ranges::adjacent_find( tableMagic.arrayValues ) == tableMagic.arrayValues.end() );
+static_assert( std::ranges::binary_search( tableMagic.GetFitting( 2 ), uint64_t { 0x5a4d } ) &&
+		std::ranges::binary_search( tableMagic.GetFitting( 2 ), uint64_t { 1500 } ) );
+static_assert( ! std::ranges::binary_search( tableMagic.GetFitting( 2 ), uint64_t { 0xfffffffe } ) &&
+		std::ranges::binary_search( tableMagic.GetFitting( 4 ), uint64_t { 0xfeffffff } ) );
+static_assert( tableMagic.arrayValues.size() > DefaultInterestingTable.arrayValues.size() );
+
 // Test mutation filtering.
 struct MockSizeModifying
 {
@@ -64,4 +90,151 @@ static_assert( std::ranges::all_of(
 	[]( auto m ) { return m.IsReducing(); } ) );
 static_assert( std::ranges::all_of(
 	Ranges::FilterMutations( GetAllSizeMofiying(), 5, 0 ),
-	[]( auto m ) { return m.IsIncreasing(); } ) );
\ No newline at end of file
+	[]( auto m ) { return m.IsIncreasing(); } ) );
+
+// Test precomputed mutation eligibility.
+constexpr EligibleMutations< 3 > eligibleMock { GetAllSizeMofiying() };
+static_assert( std::ranges::equal( eligibleMock.Get( SizeState::MustIncrease ), std::array< uint8_t, 1 > { 1 } ) );
+static_assert( std::ranges::equal( eligibleMock.Get( SizeState::CanIncrease ), std::array< uint8_t, 3 > { 0, 1, 2 } ) );
+static_assert( std::ranges::equal( eligibleMock.Get( SizeState::CannotIncrease ), std::array< uint8_t, 2 > { 0, 2 } ) );
+static_assert( GetSizeState( 5, 0 ) == SizeState::MustIncrease );
+static_assert( GetSizeState( 6, 5 ) == SizeState::CanIncrease );
+static_assert( GetSizeState( 5, 5 ) == SizeState::CannotIncrease );
+
+// Test classification of the mutation table.
+static_assert( std::ranges::count_if(
+	GetMutationTable< std::minstd_rand >(),
+	[]( auto m ) { return m.IsIncreasing(); } ) == 1 );
+static_assert( std::ranges::count_if(
+	GetMutationTable< std::minstd_rand >(),
+	[]( auto m ) { return m.IsReducing(); } ) == 1 );
+static_assert( HavocEngine< std::minstd_rand > {}.GetMutations().size() == GetMutationTable< std::minstd_rand >().size() );
+
+// Test the fast random number generators.
+static_assert( std::uniform_random_bit_generator< Xoshiro256StarStar > );
+static_assert( std::uniform_random_bit_generator< RandomBitPool< Xoshiro256StarStar > > );
+static_assert( FullWidth64< Xoshiro256StarStar > && ! FullWidth64< std::minstd_rand > );
+static_assert( BoundedSource< RandomBitPool< Xoshiro256StarStar > > && ! BoundedSource< Xoshiro256StarStar > );
+static_assert( MultiplyWide( 0xffffffffffffffff, 0xffffffffffffffff ) ==
+		std::pair< uint64_t, uint64_t > { 0xfffffffffffffffe, 1 } );
+
+//! Tests that jumping a generator produces a different, reproducible stream.
+consteval bool JumpIsReproducible()
+{
+	Xoshiro256StarStar a { 1 };
+	Xoshiro256StarStar b { 1 };
+	a.Jump();
+	b.Jump();
+	return a == b && a != Xoshiro256StarStar { 1 } && a() == b();
+}
+static_assert( JumpIsReproducible() );
+
+// Test compile-time mutation lists.
+static_assert( OpsList< DefaultOps< std::minstd_rand > > && ! OpsList< int > );
+static_assert( DefaultOps< std::minstd_rand >::Size == GetMutationTable< std::minstd_rand >().size() );
+static_assert( Ops< FlipBit< std::minstd_rand > >::GetTable< std::minstd_rand >()[ 0 ].IsConstant() );
+// Test the instrumentation policies.
+static_assert( std::is_empty_v< NoInstrumentation > );
+static_assert( MutationInstrumentation< const NoInstrumentation > && ! MutationInstrumentation< const CountingInstrumentation<> > );
+static_assert( sizeof( HavocEngine< std::minstd_rand, 5, UniformScheduler<>, NoInstrumentation > ) ==
+		sizeof( HavocEngine< std::minstd_rand, 5, UniformScheduler<>, CountingInstrumentation<> > ) -
+				sizeof( InstrumentationSnapshot<> ) );
+
+// Test the trace generators.
+static_assert( std::uniform_random_bit_generator< TraceGenerator< Xoshiro256StarStar > > &&
+		BoundedSource< TraceGenerator< Xoshiro256StarStar > > && StepObserver< TraceGenerator< Xoshiro256StarStar > > );
+static_assert( std::uniform_random_bit_generator< ReplayGenerator > && BoundedSource< ReplayGenerator > );
+static_assert( ! StepObserver< Xoshiro256StarStar > );
+
+//! Tests that dirty ranges are merged and stay within capacity.
+consteval bool DirtyRangesMerge()
+{
+	DirtyRanges< 2 > ranges;
+	ranges.Add( 10, 2, false );
+	ranges.Add( 0, 1, false );
+	ranges.Add( 12, 3, true );
+	bool bAdjacentMerged = ranges.Get().size() == 2 && ranges.Get()[ 1 ].ui64Offset == 10 && ranges.Get()[ 1 ].ui64Size == 5;
+	ranges.Add( 20, 1, false );
+	return bAdjacentMerged && ranges.Get().size() == 2 && ranges.Get()[ 1 ].ui64Size == 11 && ranges.SizeChanged();
+}
+static_assert( DirtyRangesMerge() );
+static_assert( WriteObserver< DirtyRangeGenerator< Xoshiro256StarStar > > && ! WriteObserver< Xoshiro256StarStar > );
+
+// Dictionary mutations are classified like the built-in mutations.
+using DictionaryTestGenerator = DictionaryGenerator< Xoshiro256StarStar >;
+static_assert( DictionarySource< DictionaryTestGenerator > && ! DictionarySource< Xoshiro256StarStar > );
+static_assert( GetMutationType< decltype( &DictionaryOverwrite< DictionaryTestGenerator > ), DictionaryTestGenerator >() == MutationType::Constant );
+static_assert( GetMutationType< decltype( &DictionaryInsert< DictionaryTestGenerator > ), DictionaryTestGenerator >() == MutationType::Increasing );
+
+// The splice mutation can grow and shrink the value, so it is suitable in every size state.
+using SpliceTestGenerator = SpliceGenerator< Xoshiro256StarStar >;
+static_assert( CorpusSource< SpliceTestGenerator > && ! CorpusSource< Xoshiro256StarStar > );
+static_assert( GetMutationType< decltype( &Splice< SpliceTestGenerator > ), SpliceTestGenerator >() == MutationType::Increasing );
+static_assert( GetMutationType< ResizingMutation< Splice< SpliceTestGenerator > >, SpliceTestGenerator >() == MutationType::Resizing );
+consteval bool SpliceIsAlwaysEligible()
+{
+	constexpr auto arrayMutations = SpliceOps< SpliceTestGenerator >::GetTable< SpliceTestGenerator >();
+	EligibleMutations< arrayMutations.size() > eligible { arrayMutations };
+	for( SizeState state : { SizeState::MustIncrease, SizeState::CanIncrease, SizeState::CannotIncrease } )
+		if( std::ranges::find( eligible.Get( state ), arrayMutations.size() - 1 ) == eligible.Get( state ).end() )
+			return false;
+	return arrayMutations.back().IsResizing() && ! arrayMutations.back().IsIncreasing();
+}
+static_assert( SpliceIsAlwaysEligible() );
+
+// Stack depth policies draw their depths from the documented ranges.
+static_assert( StackDepthPolicy< PowerOfTwoDepth<>, Xoshiro256StarStar > && StackDepthPolicy< AFLStackDepth<>, Xoshiro256StarStar > &&
+		StackDepthPolicy< FixedDepth< 4 >, Xoshiro256StarStar > && StackDepthPolicy< AdaptiveDepth<>, Xoshiro256StarStar > );
+constexpr bool StackDepthsInRange()
+{
+	Xoshiro256StarStar generator { 1 };
+	bool bPowerOfTwoMax = false;
+	for( int i = 0; i < 100; i++ )
+	{
+		unsigned int uiAFL = AFLStackDepth<>::Draw( 0, generator );
+		unsigned int uiAdaptive = AdaptiveDepth< 7, 1024 >::Draw( 3000, generator );
+		unsigned int uiPowerOfTwo = PowerOfTwoDepth<>::Draw( 0, generator );
+		if( ! std::has_single_bit( uiAFL ) || uiAFL < 2 || uiAFL > 128 || ! std::has_single_bit( uiAdaptive ) || uiAdaptive > 32 ||
+				AdaptiveDepth< 7, 1024 >::Draw( 1024 << 6, generator ) != 1 || PowerOfTwoDepth< 0 >::Draw( 0, generator ) != 1 ||
+				! std::has_single_bit( uiPowerOfTwo ) || uiPowerOfTwo > 32 )
+			return false;
+		bPowerOfTwoMax |= uiPowerOfTwo == 32;
+	}
+
+	// The default depth reaches 2^5 like the rounds of the original havoc.
+	return bPowerOfTwoMax && FixedDepth< 3 >::Draw( 0, generator ) == 3;
+}
+static_assert( StackDepthsInRange() );
+
+// Mutations with a clone policy are classified like the default ones.
+static_assert( ClonePolicy< DirectClone > && ClonePolicy< ScratchClone<> > );
+
+// Blocks between the register moves and the threshold are cloned through the scratch with the default threshold.
+static_assert( ScratchClone<>::IsScratchCopy( 17 ) && ScratchClone<>::IsScratchCopy( 64 ) && ! ScratchClone<>::IsScratchCopy( 16 ) &&
+		! ScratchClone<>::IsScratchCopy( 65 ) && ! ScratchClone< 16 >::IsScratchCopy( 16 ) );
+static_assert( GetMutationType< decltype( &RandomChunkOverwrite< Xoshiro256StarStar, ScratchClone<> > ), Xoshiro256StarStar >() == MutationType::Constant );
+static_assert( GetMutationType< decltype( &RandomBlockInsert< Xoshiro256StarStar, ScratchClone<> > ), Xoshiro256StarStar >() == MutationType::Increasing );
+
+// Generator adaptors forward the hooks of the generators they wrap in any order.
+static_assert( DictionarySource< UndoGenerator< DictionaryGenerator< Xoshiro256StarStar > > > );
+static_assert( CorpusSource< EffectiveGenerator< SpliceGenerator< Xoshiro256StarStar > > > );
+static_assert( WriteObserver< DictionaryGenerator< UndoGenerator< Xoshiro256StarStar > > > &&
+		MoveObserver< DictionaryGenerator< UndoGenerator< Xoshiro256StarStar > > > );
+static_assert( StepObserver< DictionaryGenerator< EffectiveGenerator< Xoshiro256StarStar > > > &&
+		EffectObserver< SpliceGenerator< EffectiveGenerator< Xoshiro256StarStar > > > );
+static_assert( OffsetSource< UndoGenerator< HotRegionGenerator< Xoshiro256StarStar > > > &&
+		OffsetSource< TraceGenerator< HotRegionGenerator< Xoshiro256StarStar > > > && ! OffsetSource< UndoGenerator< Xoshiro256StarStar > > );
+static_assert( ! StepObserver< UndoGenerator< Xoshiro256StarStar > > && ! WriteObserver< DictionaryTestGenerator > );
+static_assert( DictionaryOps< DictionaryTestGenerator >::Size == DefaultOps< DictionaryTestGenerator >::Size + 2 &&
+		SpliceOps< SpliceTestGenerator >::Size == DefaultOps< SpliceTestGenerator >::Size + 1 );
+
+// The piece table operations are matched to the mutations by their functions, not by their positions.
+constexpr auto arrayDefaultDispatch = GetPieceDispatch< Xoshiro256StarStar >( DefaultOps< Xoshiro256StarStar > {} );
+static_assert( arrayDefaultDispatch[ 0 ].operation == PieceOperation::Window && arrayDefaultDispatch[ 0 ].sizeWindow == 1 &&
+		arrayDefaultDispatch[ 2 ].sizeWindow == 8 && arrayDefaultDispatch[ 5 ].operation == PieceOperation::Remove &&
+		arrayDefaultDispatch[ 6 ].operation == PieceOperation::Insert && arrayDefaultDispatch[ 7 ].operation == PieceOperation::Overwrite );
+constexpr auto arrayReorderedDispatch = GetPieceDispatch< Xoshiro256StarStar >(
+		Ops< RandomChunkOverwrite< Xoshiro256StarStar >, ArithmeticSmallDelta< Xoshiro256StarStar >, Splice< SpliceTestGenerator > > {} );
+static_assert( arrayReorderedDispatch[ 0 ].operation == PieceOperation::Overwrite &&
+		arrayReorderedDispatch[ 1 ].operation == PieceOperation::Window && arrayReorderedDispatch[ 1 ].sizeWindow == 8 &&
+		arrayReorderedDispatch[ 2 ].operation == PieceOperation::Contiguous );
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <iostream>
+
+//! Callbacks of the custom mutator library.
+struct CustomMutatorLibrary
+{
+	void* ( *pInit )( void*, unsigned int ) = nullptr;
+	size_t ( *pFuzz )( void*, unsigned char*, size_t, unsigned char**, unsigned char*, size_t, size_t ) = nullptr;
+	size_t ( *pHavocMutation )( void*, unsigned char*, size_t, unsigned char**, size_t ) = nullptr;
+	void ( *pDeinit )( void* ) = nullptr;
+};
+
+//! Looks up a callback like AFL++ does.
+template< class Function >
+bool LoadCallback( void* pLibrary, const char* pName, Function& function )
+{
+	function = reinterpret_cast< Function >( dlsym( pLibrary, pName ) );
+	if( function == nullptr )
+		std::cerr << "Missing " << pName << std::endl;
+	return function != nullptr;
+}
+
+bool TestCallbacksMutate( const CustomMutatorLibrary& library )
+{
+	// Every mutant fits the limit of AFL++ and is written to the output buffer of the mutator.
+	void* pMutator = library.pInit( nullptr, 1 );
+	if( pMutator == nullptr )
+		return false;
+	std::array< unsigned char, 64 > arrayInput {};
+	for( size_t i = 0; i < arrayInput.size(); i++ )
+		arrayInput[ i ] = static_cast< unsigned char >( i );
+	bool bChanged = false;
+	for( int i = 0; i < 1000; i++ )
+	{
+		unsigned char* pOutput = nullptr;
+		size_t sizeFuzz = library.pFuzz( pMutator, arrayInput.data(), arrayInput.size(), &pOutput, nullptr, 0, 128 );
+		if( pOutput == nullptr || pOutput == arrayInput.data() || sizeFuzz > 128 )
+			return false;
+		bChanged |= sizeFuzz != arrayInput.size() || ! std::equal( arrayInput.begin(), arrayInput.end(), pOutput );
+
+		size_t sizeHavoc = library.pHavocMutation( pMutator, arrayInput.data(), arrayInput.size(), &pOutput, arrayInput.size() );
+		if( pOutput == nullptr || sizeHavoc > arrayInput.size() )
+			return false;
+	}
+	library.pDeinit( pMutator );
+	return bChanged;
+}
+
+bool TestCapacityFromEnvironment( const CustomMutatorLibrary& library )
+{
+	// Mutants are limited to the configured capacity.
+	setenv( "AFL_MUTATION_FUNCTIONS_MAX_SIZE", "16", 1 );
+	void* pMutator = library.pInit( nullptr, 2 );
+	if( pMutator == nullptr )
+		return false;
+	std::array< unsigned char, 64 > arrayInput {};
+	for( int i = 0; i < 100; i++ )
+	{
+		unsigned char* pOutput = nullptr;
+		if( library.pFuzz( pMutator, arrayInput.data(), arrayInput.size(), &pOutput, nullptr, 0, 128 ) > 16 || pOutput == nullptr )
+			return false;
+	}
+	library.pDeinit( pMutator );
+
+	// An output buffer that cannot be allocated fails the initialization instead of throwing.
+	setenv( "AFL_MUTATION_FUNCTIONS_MAX_SIZE", "1152921504606846976", 1 );
+	void* pHuge = library.pInit( nullptr, 3 );
+	unsetenv( "AFL_MUTATION_FUNCTIONS_MAX_SIZE" );
+	return pHuge == nullptr;
+}
+
+int main()
+{
+	// Load the library.
+	void* pLibrary = dlopen( AFL_MUTATION_FUNCTIONS_CUSTOM_MUTATOR, RTLD_NOW | RTLD_LOCAL );
+	if( pLibrary == nullptr )
+	{
+		std::cerr << "dlopen failed: " << dlerror() << std::endl;
+		return 1;
+	}
+	CustomMutatorLibrary library;
+	if( ! LoadCallback( pLibrary, "afl_custom_init", library.pInit ) || ! LoadCallback( pLibrary, "afl_custom_fuzz", library.pFuzz ) ||
+			! LoadCallback( pLibrary, "afl_custom_havoc_mutation", library.pHavocMutation ) ||
+			! LoadCallback( pLibrary, "afl_custom_deinit", library.pDeinit ) )
+		return 1;
+
+	if( ! TestCallbacksMutate( library ) )
+	{
+		std::cerr << "TestCallbacksMutate failed" << std::endl;
+		return 1;
+	}
+	if( ! TestCapacityFromEnvironment( library ) )
+	{
+		std::cerr << "TestCapacityFromEnvironment failed" << std::endl;
+		return 1;
+	}
+
+	dlclose( pLibrary );
+	std::cout << "All tests passed" << std::endl;
+	return 0;
+}
\ No newline at end of file
@@ -1,9 +1,40 @@
 #include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/Async.hh"
+#include "AFLMutationFunctions/Batch.hh"
+#include "AFLMutationFunctions/Corpus.hh"
+#include "AFLMutationFunctions/Deterministic.hh"
+#include "AFLMutationFunctions/Dictionary.hh"
+#include "AFLMutationFunctions/DirtyRanges.hh"
+#include "AFLMutationFunctions/Effective.hh"
+#include "AFLMutationFunctions/Fields.hh"
+#include "AFLMutationFunctions/HotRegions.hh"
+#include "AFLMutationFunctions/Parallel.hh"
+#include "AFLMutationFunctions/PieceTable.hh"
+#include "AFLMutationFunctions/SharedTestcase.hh"
+#include "AFLMutationFunctions/Streaming.hh"
+#include "AFLMutationFunctions/Trace.hh"
+#include "AFLMutationFunctions/Undo.hh"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <coroutine>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <vector>
 
 using namespace AFLMutationFunctions;
 using namespace AFLMutationFunctions::Details;
 
+//! Number of heap allocations made by the test program. Counted by the operators in AllocationCounter.cpp.
+extern size_t g_sizeAllocations;
+
 bool TestFunctionsDoMutate()
 {
 	using MutationType = Mutation< std::default_random_engine >;
@@ -52,6 +83,1119 @@ bool TestHavoc( bool bPrint = false )
 	return ui64Value != 0;
 }
 
+bool TestHavocEngineDoesNotAllocate()
+{
+	std::array< byte, 16 > arrayBuffer {};
+	auto random = std::default_random_engine { std::random_device {}() };
+	HavocEngine< std::default_random_engine > engine;
+	size_t sizeValue = sizeof( uint64_t );
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	for( int i = 0; i < 50000; i++ )
+		sizeValue = engine( arrayBuffer, sizeValue, random ).size();
+
+	return g_sizeAllocations == sizeAllocationsBefore &&
+			std::ranges::any_of( arrayBuffer, []( byte b ) { return b != byte { 0 }; } );
+}
+
+bool TestAliasTableMatchesWeights()
+{
+	// Sample a table and compare the frequencies to the weights.
+	const std::array< uint8_t, 4 > arrayValues { 0, 1, 2, 3 };
+	const std::array< double, 4 > arrayWeights { 1, 2, 3, 0 };
+	AliasTable< 4 > table;
+	table.Build( arrayValues, arrayWeights );
+	auto random = std::default_random_engine { std::random_device {}() };
+	std::array< int, 4 > arrayCounts {};
+	const int iSamples = 60000;
+	for( int i = 0; i < iSamples; i++ )
+		arrayCounts[ table.Sample( random ) ]++;
+
+	for( size_t i = 0; i < arrayCounts.size(); i++ )
+	{
+		double dExpected = iSamples * arrayWeights[ i ] / 6;
+		if( std::abs( arrayCounts[ i ] - dExpected ) > iSamples * 0.02 )
+			return false;
+	}
+	return true;
+}
+
+bool TestWeightedSchedulerAdapts()
+{
+	// Report new coverage only when the first mutation was used.
+	auto random = std::default_random_engine { std::random_device {}() };
+	HavocEngine< std::default_random_engine, 1, WeightedScheduler<> > engine {
+		GetMutationTable< std::default_random_engine >(), WeightedScheduler<> { {}, 16 } };
+	std::array< byte, 16 > arrayBuffer {};
+	for( int i = 0; i < 5000; i++ )
+	{
+		uint64_t ui64SelectionsBefore = engine.GetScheduler().GetStatistics()[ 0 ].ui64Selections;
+		engine( arrayBuffer, 8, random );
+		engine.GetScheduler().Report( engine.GetScheduler().GetStatistics()[ 0 ].ui64Selections != ui64SelectionsBefore );
+	}
+
+	// The first mutation should now have the largest weight.
+	auto weights = engine.GetScheduler().GetWeights();
+	return std::ranges::max_element( weights ) == weights.begin() &&
+			engine.GetScheduler().GetStatistics()[ 0 ].ui64Finds > 0;
+}
+
+bool TestHavocBatch()
+{
+	// Fill an arena with mutants of a seed.
+	const std::array< byte, 8 > arraySeed { byte { 1 }, byte { 2 }, byte { 3 }, byte { 4 } };
+	const size_t sizeCapacity = 12;
+	MutantArena arena { sizeCapacity, 64 };
+	HavocEngine< std::default_random_engine > engine;
+	auto random = std::default_random_engine { std::random_device {}() };
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	if( arena.Fill( engine, arraySeed, random ) != 64 || g_sizeAllocations != sizeAllocationsBefore )
+		return false;
+
+	// Mutants must be aligned, bounded and some of them must differ from the seed.
+	bool bMutated = false;
+	for( size_t i = 0; i < arena.Size(); i++ )
+	{
+		const MutantSlot& slot = arena.GetSlots()[ i ];
+		if( slot.ui64Offset % BatchAlignment != 0 || slot.ui64Size > sizeCapacity )
+			return false;
+		bMutated |= ! std::ranges::equal( arena[ i ], std::span { arraySeed } );
+	}
+	return bMutated;
+}
+
+//! Tests that observed counts are consistent with a uniform distribution using a chi-squared test.
+template< std::ranges::sized_range Range >
+bool IsUniform( const Range& counts )
+{
+	// Accept statistics within six standard deviations of the expected value.
+	double dTotal = 0;
+	for( auto count : counts )
+		dTotal += count;
+	double dExpected = dTotal / std::ranges::size( counts );
+	double dChiSquared = 0;
+	for( auto count : counts )
+		dChiSquared += ( count - dExpected ) * ( count - dExpected ) / dExpected;
+	double dFreedom = std::ranges::size( counts ) - 1.0;
+	return dChiSquared < dFreedom + 6 * std::sqrt( 2 * dFreedom );
+}
+
+//! Tests that bounded draws of a generator are uniform.
+template< class Gen >
+bool TestRandomInRangeIsUniform( Gen generator )
+{
+	for( size_t sizeRange : { 2, 7, 8, 100, 255 } )
+	{
+		std::vector< int > vecCounts( sizeRange );
+		for( size_t i = 0; i < sizeRange * 1000; i++ )
+			vecCounts[ RandomInRange< size_t >( 0, sizeRange - 1, generator ) ]++;
+		if( ! IsUniform( vecCounts ) )
+			return false;
+	}
+	return true;
+}
+
+//! Tests that the bit flipped and the replacement byte are uniformly distributed.
+template< class Gen >
+bool TestOperatorDistributionsAreUniform( Gen generator )
+{
+	// Record which bit was flipped.
+	std::array< byte, 16 > arrayBuffer {};
+	std::vector< int > vecFlips( arrayBuffer.size() * 8 );
+	for( int i = 0; i < 128000; i++ )
+	{
+		FlipBit( arrayBuffer, generator );
+		auto it = std::ranges::find_if( arrayBuffer, []( byte b ) { return b != byte { 0 }; } );
+		if( it == arrayBuffer.end() )
+			return false;
+		size_t sizeBit = std::countr_zero( std::to_integer< unsigned int >( *it ) );
+		vecFlips[ ( it - arrayBuffer.begin() ) * 8 + sizeBit ]++;
+		*it = byte { 0 };
+	}
+
+	// Record the replacement values.
+	std::vector< int > vecValues( 255 );
+	for( int i = 0; i < 255000; i++ )
+	{
+		RandomByteReplace( std::span { arrayBuffer }.subspan( 0, 1 ), generator );
+		vecValues[ std::to_integer< size_t >( arrayBuffer[ 0 ] ) - 1 ]++;
+	}
+
+	return IsUniform( vecFlips ) && IsUniform( vecValues );
+}
+
+bool TestFastRandom()
+{
+	// The fast generators and the standard generators must produce the same distributions.
+	auto seed = std::random_device {}();
+	if( ! TestRandomInRangeIsUniform( std::default_random_engine { seed } ) ||
+			! TestRandomInRangeIsUniform( Xoshiro256StarStar { seed } ) ||
+			! TestRandomInRangeIsUniform( RandomBitPool< Xoshiro256StarStar > { Xoshiro256StarStar { seed } } ) ||
+			! TestOperatorDistributionsAreUniform( std::default_random_engine { seed } ) ||
+			! TestOperatorDistributionsAreUniform( RandomBitPool< Xoshiro256StarStar > { Xoshiro256StarStar { seed } } ) )
+		return false;
+
+	// Havoc must work with the pool without allocating.
+	std::array< byte, 16 > arrayBuffer {};
+	RandomBitPool< Xoshiro256StarStar > random { Xoshiro256StarStar { seed } };
+	HavocEngine< RandomBitPool< Xoshiro256StarStar > > engine;
+	size_t sizeValue = 8;
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	for( int i = 0; i < 50000; i++ )
+		sizeValue = engine( arrayBuffer, sizeValue, random ).size();
+	return g_sizeAllocations == sizeAllocationsBefore;
+}
+
+bool TestStaticHavoc()
+{
+	// Mutate with the default mutations.
+	using Gen = Xoshiro256StarStar;
+	Gen random { std::random_device {}() };
+	std::array< byte, 16 > arrayBuffer {};
+	size_t sizeValue = 8;
+	for( int i = 0; i < 50000; i++ )
+		sizeValue = Havoc< DefaultOps< Gen > >( arrayBuffer, sizeValue, random ).size();
+	if( std::ranges::all_of( arrayBuffer, []( byte b ) { return b == byte { 0 }; } ) )
+		return false;
+
+	// Only flip bits so that every iteration changes the parity of the set bits.
+	uint64_t ui64Value = 0;
+	auto spanBytes = std::as_writable_bytes( std::span { &ui64Value, 1 } );
+	for( int i = 0; i < 1000; i++ )
+	{
+		int iBitsBefore = std::popcount( ui64Value );
+		if( Havoc< Ops< FlipBit< Gen > >, 0 >( spanBytes, spanBytes.size(), random ).size() != spanBytes.size() ||
+				( std::popcount( ui64Value ) - iBitsBefore ) % 2 == 0 )
+			return false;
+	}
+
+	// An empty value cannot be mutated without increasing mutations.
+	return Havoc< Ops< FlipBit< Gen > > >( spanBytes, 0, random ).empty();
+}
+
+bool TestBlockOperationsKeepData()
+{
+	auto random = std::default_random_engine { std::random_device {}() };
+	for( int i = 0; i < 1000; i++ )
+	{
+		// Removing a block must keep the bytes around it and zero the vacated bytes.
+		std::array< byte, 16 > arrayBuffer {};
+		for( size_t j = 0; j < arrayBuffer.size(); j++ )
+			arrayBuffer[ j ] = static_cast< byte >( j + 1 );
+		auto spanValue = RemoveRandomBlock( arrayBuffer, random );
+		size_t sizeRemoved = arrayBuffer.size() - spanValue.size();
+		size_t sizeGap = 0;
+		while( sizeGap < spanValue.size() && spanValue[ sizeGap ] == static_cast< byte >( sizeGap + 1 ) )
+			sizeGap++;
+		for( size_t j = sizeGap; j < spanValue.size(); j++ )
+		{
+			if( spanValue[ j ] != static_cast< byte >( j + sizeRemoved + 1 ) )
+				return false;
+		}
+		if( ! std::ranges::all_of( std::span { arrayBuffer }.subspan( spanValue.size() ), []( byte b ) { return b == byte { 0 }; } ) )
+			return false;
+
+		// Inserting a block must keep the value around the block.
+		std::array< byte, 16 > arrayInsert {};
+		for( size_t j = 0; j < 8; j++ )
+			arrayInsert[ j ] = static_cast< byte >( j + 1 );
+		auto spanInserted = RandomBlockInsert( arrayInsert, 8, random );
+		size_t sizeInserted = spanInserted.size() - 8;
+		size_t sizeHead = 0;
+		while( sizeHead < 8 && arrayInsert[ sizeHead ] == static_cast< byte >( sizeHead + 1 ) )
+			sizeHead++;
+		bool bTailKept = false;
+		for( size_t sizeBegin = 0; sizeBegin <= sizeHead && ! bTailKept; sizeBegin++ )
+		{
+			bTailKept = true;
+			for( size_t j = sizeBegin; j < 8; j++ )
+				bTailKept &= arrayInsert[ j + sizeInserted ] == static_cast< byte >( j + 1 );
+		}
+		if( ! bTailKept )
+			return false;
+	}
+	return true;
+}
+
+bool TestPieceTableMatchesVector()
+{
+	// Apply the same random edits to a piece table and a vector.
+	auto random = std::default_random_engine { std::random_device {}() };
+	std::vector< byte > vecBuffer( 256 );
+	PieceTable table { 4096, 64 };
+	for( int iRound = 0; iRound < 200; iRound++ )
+	{
+		for( size_t i = 0; i < vecBuffer.size(); i++ )
+			vecBuffer[ i ] = static_cast< byte >( i );
+		std::vector< byte > vecExpected( vecBuffer.begin(), vecBuffer.begin() + 128 );
+		table.Reset( vecBuffer, vecExpected.size() );
+		for( int iEdit = 0; iEdit < 16; iEdit++ )
+		{
+			size_t sizeOffset = RandomInRange< size_t >( 0, vecExpected.size(), random );
+			size_t sizeBlock = RandomInRange< size_t >( 0, std::min< size_t >( 8, vecExpected.size() - sizeOffset ), random );
+			switch( RandomInRange( 0u, 2u, random ) )
+			{
+			case 0:
+				if( vecExpected.size() + 8 <= vecBuffer.size() )
+				{
+					std::span< byte > spanBlock = table.Allocate( 8 );
+					std::ranges::fill( spanBlock, static_cast< byte >( iEdit ) );
+					table.Insert( sizeOffset, spanBlock );
+					vecExpected.insert( vecExpected.begin() + sizeOffset, 8, static_cast< byte >( iEdit ) );
+				}
+				break;
+			case 1:
+				table.Erase( sizeOffset, sizeBlock );
+				vecExpected.erase( vecExpected.begin() + sizeOffset, vecExpected.begin() + sizeOffset + sizeBlock );
+				break;
+			default:
+				std::vector< byte > vecBytes( sizeBlock, byte { 0xaa } );
+				table.Write( sizeOffset, vecBytes );
+				std::ranges::copy( vecBytes, vecExpected.begin() + sizeOffset );
+				break;
+			}
+
+			// Reading must see the edits before flattening.
+			std::vector< byte > vecRead( table.Size() );
+			table.Read( 0, vecRead );
+			if( vecRead != vecExpected )
+				return false;
+		}
+
+		if( ! std::ranges::equal( table.Flatten(), vecExpected ) )
+			return false;
+	}
+	return true;
+}
+
+bool TestPieceTableHavoc()
+{
+	// Mutate a large value repeatedly.
+	auto random = Xoshiro256StarStar { std::random_device {}() };
+	std::vector< byte > vecBuffer( 1 << 16 );
+	PieceTable table { vecBuffer.size(), 256 };
+	size_t sizeValue = vecBuffer.size() / 2;
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	for( int i = 0; i < 2000; i++ )
+	{
+		auto spanValue = PieceTableHavoc( table, vecBuffer, sizeValue, random );
+		if( spanValue.data() != vecBuffer.data() || spanValue.size() > vecBuffer.size() )
+			return false;
+		sizeValue = spanValue.size();
+	}
+	return g_sizeAllocations == sizeAllocationsBefore &&
+			std::ranges::any_of( vecBuffer, []( byte b ) { return b != byte { 0 }; } );
+}
+
+bool TestInstrumentationCountsMutations()
+{
+	// Grow and shrink a value and compare the counters to the engine's behavior.
+	std::array< byte, 64 > arrayBuffer {};
+	auto random = std::default_random_engine { std::random_device {}() };
+	HavocEngine< std::default_random_engine, 5, UniformScheduler<>, CountingInstrumentation< true > > engine;
+	size_t sizeValue = 16;
+	const int iRounds = 2000;
+	for( int i = 0; i < iRounds; i++ )
+		sizeValue = engine( arrayBuffer, sizeValue, random ).size();
+
+	InstrumentationSnapshot<> snapshot = engine.GetInstrumentation().GetSnapshot();
+	uint64_t ui64Inserted = 0;
+	uint64_t ui64Removed = 0;
+	for( const MutationCounters& counters : snapshot.arrayMutations )
+	{
+		ui64Inserted += counters.ui64BytesInserted;
+		ui64Removed += counters.ui64BytesRemoved;
+		if( std::accumulate( counters.arrayCycleHistogram.begin(), counters.arrayCycleHistogram.end(), uint64_t { 0 } ) !=
+				counters.ui64Selections )
+			return false;
+	}
+
+	// Merged snapshots add up.
+	InstrumentationSnapshot<> merged = snapshot;
+	merged += snapshot;
+	engine.GetInstrumentation().Reset();
+	return snapshot.ui64Rounds == iRounds &&
+			snapshot.GetAppliedIterations() == snapshot.ui64PlannedIterations &&
+			snapshot.ui64MustIncrease + snapshot.ui64CanIncrease + snapshot.ui64CannotIncrease == snapshot.ui64PlannedIterations &&
+			16 + ui64Inserted - ui64Removed == sizeValue &&
+			merged.GetAppliedIterations() == 2 * snapshot.GetAppliedIterations() &&
+			engine.GetInstrumentation().GetSnapshot().ui64Rounds == 0;
+}
+
+bool TestWorkStealingDequeTakesEveryItemOnce()
+{
+	// The owner pushes and pops while thieves steal concurrently.
+	const size_t sizeItems = 100000;
+	WorkStealingDeque< size_t > deque { 64 };
+	std::vector< std::atomic< int > > vecTaken( sizeItems );
+	std::atomic< bool > bDone = false;
+	std::vector< std::jthread > vecThieves;
+	for( int i = 0; i < 3; i++ )
+	{
+		vecThieves.emplace_back( [ & ]() {
+			while( ! bDone.load() )
+			{
+				if( std::optional< size_t > item = deque.Steal() )
+					vecTaken[ *item ]++;
+			}
+		} );
+	}
+
+	for( size_t i = 0; i < sizeItems; )
+	{
+		if( deque.Push( i ) )
+			i++;
+		else if( std::optional< size_t > item = deque.Pop() )
+			vecTaken[ *item ]++;
+	}
+	while( std::optional< size_t > item = deque.Pop() )
+		vecTaken[ *item ]++;
+	bDone = true;
+	vecThieves.clear();
+
+	return std::ranges::all_of( vecTaken, []( const std::atomic< int >& taken ) { return taken.load() == 1; } );
+}
+
+bool TestParallelHavoc()
+{
+	// Consume mutants of every worker and check that every entry is mutated.
+	std::array< std::vector< byte >, 5 > arrayEntries {};
+	for( size_t i = 0; i < arrayEntries.size(); i++ )
+		arrayEntries[ i ].assign( 8 + i * 16, byte { static_cast< uint8_t >( i ) } );
+	std::array< std::span< const byte >, 5 > arrayCorpus {};
+	for( size_t i = 0; i < arrayEntries.size(); i++ )
+		arrayCorpus[ i ] = arrayEntries[ i ];
+
+	const size_t sizeCapacity = 100;
+	ParallelHavoc<> pool { arrayCorpus, sizeCapacity, 4, 1, 32, 4 };
+	std::array< size_t, 5 > arrayCounts {};
+	size_t sizeConsumed = 0;
+	bool bValid = true;
+	while( sizeConsumed < 4000 )
+	{
+		for( size_t i = 0; i < pool.GetWorkerCount(); i++ )
+		{
+			while( std::optional< RingMutant > mutant = pool.GetRing( i ).Peek() )
+			{
+				bValid = bValid && mutant->sizeEntry < arrayCorpus.size() && mutant->spanData.size() <= sizeCapacity;
+				arrayCounts[ std::min( mutant->sizeEntry, arrayCounts.size() - 1 ) ]++;
+				pool.GetRing( i ).Release();
+				sizeConsumed++;
+			}
+		}
+	}
+	pool.Stop();
+
+	return bValid && std::ranges::all_of( arrayCounts, []( size_t count ) { return count > 0; } );
+}
+
+bool TestTraceReplaysHavoc()
+{
+	// Replaying the trace of a round on the original value reproduces the mutant.
+	std::array< byte, 64 > arrayOriginal {};
+	std::array< byte, 64 > arrayMutant {};
+	std::array< byte, 64 > arrayReplay {};
+	TraceGenerator< Xoshiro256StarStar > tracer { Xoshiro256StarStar { std::random_device {}() } };
+	HavocEngine< TraceGenerator< Xoshiro256StarStar > > engine;
+	size_t sizeValue = 16;
+	for( int i = 0; i < 5000; i++ )
+	{
+		arrayOriginal = arrayMutant;
+		std::span< byte > spanMutant = engine( arrayMutant, sizeValue, tracer );
+		arrayReplay = arrayOriginal;
+		std::span< byte > spanReplay = ReplayHavoc( arrayReplay, sizeValue, tracer.GetTrace() );
+		if( ! tracer.GetTrace().IsComplete() || ! std::ranges::equal( spanMutant, spanReplay ) ||
+				arrayMutant != arrayReplay )
+			return false;
+
+		// Dropping steps keeps the replay within the buffer.
+		MutationTrace<> trace = tracer.GetTrace();
+		while( trace.Size() > 0 )
+		{
+			trace.RemoveStep( trace.Size() / 2 );
+			arrayReplay = arrayOriginal;
+			if( ReplayHavoc( arrayReplay, sizeValue, trace ).size() > arrayReplay.size() )
+				return false;
+		}
+		sizeValue = spanMutant.size();
+	}
+	return true;
+}
+
+bool TestDirtyRangesCoverChanges()
+{
+	// Every changed byte is in a dirty range, and copying the ranges reproduces the mutant.
+	std::array< byte, 256 > arrayMutant {};
+	for( size_t i = 0; i < arrayMutant.size(); i++ )
+		arrayMutant[ i ] = static_cast< byte >( i );
+	DirtyRangeGenerator< Xoshiro256StarStar, 4 > tracker { Xoshiro256StarStar { std::random_device {}() } };
+	HavocEngine< DirtyRangeGenerator< Xoshiro256StarStar, 4 > > engine;
+	size_t sizeValue = 128;
+	for( int i = 0; i < 5000; i++ )
+	{
+		std::array< byte, 256 > arrayOriginal = arrayMutant;
+		size_t sizeMutant = engine( arrayMutant, sizeValue, tracker ).size();
+		std::span< const DirtyRange > spanRanges = tracker.GetRanges().Get();
+		for( size_t b = 0; b < arrayMutant.size(); b++ )
+		{
+			bool bDirty = std::ranges::any_of( spanRanges, [ b ]( const DirtyRange& range ) {
+				return b >= range.ui64Offset && b < range.ui64Offset + range.ui64Size;
+			} );
+			if( arrayMutant[ b ] != arrayOriginal[ b ] && ! bDirty )
+				return false;
+		}
+		if( sizeMutant != sizeValue && ! tracker.GetRanges().SizeChanged() )
+			return false;
+
+		// Patch and restore a copy of the original.
+		std::array< byte, 256 > arrayPatched = arrayOriginal;
+		CopyDirtyRanges( arrayPatched, arrayMutant, spanRanges );
+		if( arrayPatched != arrayMutant )
+			return false;
+		CopyDirtyRanges( arrayPatched, arrayOriginal, spanRanges );
+		if( arrayPatched != arrayOriginal )
+			return false;
+		sizeValue = sizeMutant;
+	}
+	return true;
+}
+
+bool TestUndoJournalReverts()
+{
+	// Revert one to three rounds applied in place without allocating.
+	std::array< byte, 256 > arraySeed {};
+	for( size_t i = 0; i < arraySeed.size(); i++ )
+		arraySeed[ i ] = static_cast< byte >( i * 7 );
+	std::array< byte, 256 > arrayBuffer = arraySeed;
+	UndoGenerator< Xoshiro256StarStar > journaler { Xoshiro256StarStar { std::random_device {}() }, 1 << 16 };
+	HavocEngine< UndoGenerator< Xoshiro256StarStar > > engine;
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	for( int i = 0; i < 5000; i++ )
+	{
+		size_t sizeValue = 128;
+		for( int r = 0; r <= i % 3; r++ )
+			sizeValue = engine( arrayBuffer, sizeValue, journaler ).size();
+		if( ! journaler.Revert( arrayBuffer ) || arrayBuffer != arraySeed )
+			return false;
+	}
+	bool bNoAllocations = g_sizeAllocations == sizeAllocationsBefore;
+
+	// A journal that overflows refuses to revert and leaves the buffer alone.
+	UndoGenerator< Xoshiro256StarStar > small { Xoshiro256StarStar { 1 }, 1 };
+	size_t sizeValue = 128;
+	while( small.GetJournal().IsComplete() )
+		sizeValue = engine( arrayBuffer, sizeValue, small ).size();
+	std::array< byte, 256 > arrayMutant = arrayBuffer;
+	return bNoAllocations && ! small.Revert( arrayBuffer ) && arrayBuffer == arrayMutant;
+}
+
+bool TestDictionaryMutations()
+{
+	// Tokens are sorted by size and only fitting tokens are selected.
+	TokenDictionary dictionary;
+	std::array< std::array< byte, 4 >, 3 > arrayTokens { { { byte { 'a' }, byte { 'b' }, byte { 'c' }, byte { 'd' } },
+			{ byte { 'e' }, byte { 'f' } }, { byte { 'g' } } } };
+	if( ! dictionary.Add( std::span { arrayTokens[ 0 ] } ) || ! dictionary.Add( std::span { arrayTokens[ 1 ] }.first( 2 ) ) ||
+			! dictionary.Add( std::span { arrayTokens[ 2 ] }.first( 1 ) ) || dictionary.Add( {} ) )
+		return false;
+	if( dictionary.Size() != 3 || dictionary.Get( 0 ).size() != 1 || dictionary.Get( 1 ).size() != 2 ||
+			dictionary.Get( 2 ).size() != 4 || dictionary.CountFitting( 3 ) != 2 || dictionary.CountFitting( 1000 ) != 3 )
+		return false;
+
+	// Every overwrite writes a whole token and every insert adds one.
+	DictionaryGenerator< Xoshiro256StarStar > generator { Xoshiro256StarStar { std::random_device {}() }, dictionary };
+	for( int i = 0; i < 1000; i++ )
+	{
+		std::array< byte, 8 > arrayBuffer {};
+		DictionaryOverwrite( std::span { arrayBuffer }.first( 3 ), generator );
+		size_t sizeWritten = std::ranges::count_if( arrayBuffer, []( byte b ) { return b != byte { 0 }; } );
+		if( sizeWritten == 0 || sizeWritten > 2 )
+			return false;
+
+		std::span< byte > spanValue = DictionaryInsert( std::span { arrayBuffer }, 3, generator );
+		size_t sizeInserted = spanValue.size() - 3;
+		if( sizeInserted == 0 || std::ranges::count_if( spanValue, []( byte b ) { return b == byte { 0 }; } ) !=
+				3 - static_cast< ptrdiff_t >( sizeWritten ) )
+			return false;
+	}
+
+	// Havoc can apply the dictionary mutations.
+	std::array< byte, 64 > arrayBuffer {};
+	size_t sizeValue = 16;
+	for( int i = 0; i < 1000; i++ )
+		sizeValue = Havoc< DictionaryOps< DictionaryGenerator< Xoshiro256StarStar > > >( arrayBuffer, sizeValue, generator ).size();
+	if( sizeValue == 0 || sizeValue > arrayBuffer.size() )
+		return false;
+
+	// An undo journal around the dictionary generator reverts the dictionary mutations too.
+	using UndoDictionaryGenerator = UndoGenerator< DictionaryGenerator< Xoshiro256StarStar > >;
+	UndoDictionaryGenerator journaler { DictionaryGenerator< Xoshiro256StarStar > { Xoshiro256StarStar { std::random_device {}() }, dictionary }, 1 << 12 };
+	std::array< byte, 64 > arraySeed = arrayBuffer;
+	for( int i = 0; i < 1000; i++ )
+	{
+		Havoc< DictionaryOps< UndoDictionaryGenerator > >( arrayBuffer, 16, journaler );
+		if( ! journaler.Revert( arrayBuffer ) || arrayBuffer != arraySeed )
+			return false;
+	}
+	return true;
+}
+
+bool TestSpliceWithMappedCorpus()
+{
+	// Map a directory of entries with different sizes.
+	std::filesystem::path pathCorpus = std::filesystem::temp_directory_path() / "afl-mutation-tests-corpus";
+	std::filesystem::remove_all( pathCorpus );
+	std::filesystem::create_directories( pathCorpus );
+	for( size_t i = 0; i < 4; i++ )
+	{
+		std::ofstream stream { pathCorpus / std::to_string( i ), std::ios::binary };
+		for( size_t b = 0; b < i * 40; b++ )
+			stream.put( static_cast< char >( b * ( i + 1 ) ) );
+	}
+	MappedCorpus corpus;
+	bool bMapped = corpus.AddDirectory( pathCorpus ) == 4 && ! corpus.Add( pathCorpus / "missing" );
+	size_t sizeTotal = 0;
+	for( std::span< const byte > spanEntry : corpus.GetEntries() )
+		sizeTotal += spanEntry.size();
+	std::filesystem::remove_all( pathCorpus );
+	if( ! bMapped || sizeTotal != 240 )
+		return false;
+
+	// Every spliced value is a head of the value followed by a tail of an entry.
+	SpliceGenerator< Xoshiro256StarStar > generator { Xoshiro256StarStar { std::random_device {}() }, corpus.GetEntries() };
+	for( int i = 0; i < 1000; i++ )
+	{
+		std::array< byte, 100 > arrayBuffer {};
+		std::ranges::fill( std::span { arrayBuffer }.first( 50 ), byte { 0xaa } );
+		std::array< byte, 100 > arrayOriginal = arrayBuffer;
+		std::span< byte > spanValue = Splice( std::span { arrayBuffer }, 50, generator );
+		bool bSpliced = std::ranges::any_of( corpus.GetEntries(), [ & ]( std::span< const byte > spanEntry ) {
+			spanEntry = spanEntry.first( std::min( spanEntry.size(), arrayBuffer.size() ) );
+			if( spanEntry.size() != spanValue.size() )
+				return false;
+			for( size_t s = 0; s <= spanValue.size(); s++ )
+			{
+				if( std::ranges::equal( spanValue.first( s ), std::span { arrayOriginal }.first( s ) ) &&
+						std::ranges::equal( spanValue.subspan( s ), spanEntry.subspan( s ) ) )
+					return true;
+			}
+			return false;
+		} );
+		if( ! bSpliced || ! std::ranges::all_of( std::span { arrayBuffer }.subspan( spanValue.size() ), []( byte b ) { return b == byte { 0 }; } ) )
+			return false;
+	}
+
+	// Havoc can apply the splice mutation.
+	std::array< byte, 64 > arrayBuffer {};
+	size_t sizeValue = 16;
+	for( int i = 0; i < 1000; i++ )
+		sizeValue = Havoc< SpliceOps< SpliceGenerator< Xoshiro256StarStar > > >( arrayBuffer, sizeValue, generator ).size();
+	if( sizeValue > arrayBuffer.size() )
+		return false;
+
+	// The splice mutation is also applied to values that fill the whole buffer.
+	using SpliceOnly = Ops< ResizingMutation< Splice< SpliceGenerator< Xoshiro256StarStar > > > {} >;
+	bool bShrunk = false;
+	for( int i = 0; i < 100; i++ )
+	{
+		std::array< byte, 64 > arrayFull {};
+		std::ranges::fill( arrayFull, byte { 0xaa } );
+		std::span< byte > spanValue = Havoc< SpliceOnly >( arrayFull, arrayFull.size(), generator );
+		bShrunk |= spanValue.size() < arrayFull.size();
+	}
+	return bShrunk;
+}
+
+bool TestIntegerWidths()
+{
+	// Small deltas change a single byte of a zeroed buffer by at most the maximum delta.
+	auto random = Xoshiro256StarStar { std::random_device {}() };
+	for( int i = 0; i < 1000; i++ )
+	{
+		std::array< byte, 11 > arrayBuffer {};
+		ArithmeticSmallDelta( std::span { arrayBuffer }, random );
+		if( std::ranges::count_if( arrayBuffer, []( byte b ) { return b != byte { 0 }; } ) != 1 ||
+				std::ranges::max( arrayBuffer ) > static_cast< byte >( ArithmeticMaxDelta ) )
+			return false;
+
+		// Subtracting restores the buffer if the same delta, width, position and endian are drawn.
+		std::array< byte, 11 > arrayMutant = arrayBuffer;
+		Xoshiro256StarStar copy = random;
+		ArithmeticSmallDelta( std::span { arrayBuffer }, random );
+		ArithmeticSmallDelta< Xoshiro256StarStar, std::minus< uint64_t > >( std::span { arrayBuffer }, copy );
+		if( arrayBuffer != arrayMutant )
+			return false;
+	}
+
+	// Interesting values wider than a byte are written.
+	bool bWide = false;
+	for( int i = 0; i < 1000 && ! bWide; i++ )
+	{
+		uint64_t ui64Value = 0;
+		InterestingValue( std::as_writable_bytes( std::span { &ui64Value, 1 } ), random );
+		bWide = std::bit_width( ui64Value ) > 8;
+	}
+	return bWide;
+}
+
+//! Interesting integers extended with a 32-bit magic number.
+inline constexpr auto g_tableMagic = MakeInterestingTable< std::array< uint32_t, 1 > { 0xfeedfacf } >();
+
+bool TestInterestingTable()
+{
+	// The magic number is written in both endians.
+	auto random = Xoshiro256StarStar { std::random_device {}() };
+	bool bLittle = false;
+	bool bBig = false;
+	for( int i = 0; i < 100000 && ! ( bLittle && bBig ); i++ )
+	{
+		uint32_t ui32Value = 0;
+		InterestingValue< Xoshiro256StarStar, g_tableMagic >( std::as_writable_bytes( std::span { &ui32Value, 1 } ), random );
+		bLittle |= ui32Value == 0xfeedfacf;
+		bBig |= ui32Value == 0xcffaedfe;
+	}
+	return bLittle && bBig;
+}
+
+bool TestHavocFields()
+{
+	// Fields stay inside their regions and the bytes between them are never touched.
+	std::array< uint8_t, 64 > arrayBuffer {};
+	std::ranges::fill( std::span { arrayBuffer }.subspan( 16, 4 ), uint8_t { 0xcc } );
+	std::ranges::fill( std::span { arrayBuffer }.subspan( 28, 12 ), uint8_t { 0xcc } );
+	const std::array< FieldLayout, 3 > arrayFields { { { 0, 16 }, { 20, 8 }, { 40, 24 } } };
+	std::array< size_t, 3 > arraySizes { 4, 8, 0 };
+	auto random = Xoshiro256StarStar { std::random_device {}() };
+	std::array< int, 3 > arrayMutated {};
+	for( int i = 0; i < 5000; i++ )
+	{
+		arrayMutated[ HavocFields( std::span< uint8_t > { arrayBuffer }, arrayFields, arraySizes, random ) ]++;
+		for( size_t f = 0; f < arrayFields.size(); f++ )
+		{
+			std::span< uint8_t > spanFree = std::span { arrayBuffer }.subspan(
+					arrayFields[ f ].sizeOffset + arraySizes[ f ], arrayFields[ f ].sizeCapacity - arraySizes[ f ] );
+			if( std::ranges::any_of( spanFree, []( uint8_t b ) { return b != 0; } ) )
+				return false;
+		}
+		if( std::ranges::any_of( std::span { arrayBuffer }.subspan( 16, 4 ), []( uint8_t b ) { return b != 0xcc; } ) ||
+				std::ranges::any_of( std::span { arrayBuffer }.subspan( 28, 12 ), []( uint8_t b ) { return b != 0xcc; } ) )
+			return false;
+	}
+
+	// Buffers of characters can be mutated directly.
+	std::array< char, 16 > arrayText {};
+	size_t sizeText = 8;
+	for( int i = 0; i < 100; i++ )
+		sizeText = Havoc( std::span< char > { arrayText }, sizeText, random ).size();
+	if( sizeText > arrayText.size() )
+		return false;
+
+	// A havoc engine can be used for the fields, and every field is mutated.
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( int i = 0; i < 100; i++ )
+		arrayMutated[ HavocFields( engine, std::as_writable_bytes( std::span { arrayBuffer } ), arrayFields, arraySizes, random ) ]++;
+	if( ! std::ranges::all_of( arrayMutated, []( int iCount ) { return iCount > 0; } ) )
+		return false;
+
+	// Observers see offsets in the buffer, so an undo journal reverts the fields and dirty ranges stay in the mutated field.
+	std::span< byte > spanBytes = std::as_writable_bytes( std::span { arrayBuffer } );
+	std::array< uint8_t, 64 > arraySeed = arrayBuffer;
+	std::array< size_t, 3 > arraySeedSizes = arraySizes;
+	UndoGenerator< DirtyRangeGenerator< Xoshiro256StarStar > > journaler { DirtyRangeGenerator< Xoshiro256StarStar > { random }, 1 << 12 };
+	for( int i = 0; i < 1000; i++ )
+	{
+		size_t index = HavocFields( spanBytes, arrayFields, arraySizes, journaler );
+		for( const DirtyRange& range : journaler.Base().GetRanges().Get() )
+			if( range.ui64Offset < arrayFields[ index ].sizeOffset ||
+					range.ui64Offset + range.ui64Size > arrayFields[ index ].sizeOffset + arrayFields[ index ].sizeCapacity )
+				return false;
+		if( ! journaler.Revert( spanBytes ) || arrayBuffer != arraySeed )
+			return false;
+		arraySizes = arraySeedSizes;
+	}
+
+	// Fields must start inside the buffer even when they are empty.
+	const std::array< FieldLayout, 1 > arrayOutside { { { 80, 0 } } };
+	const std::array< size_t, 1 > arrayEmpty { 0 };
+	return IsValidLayout( 80, arrayOutside, arrayEmpty ) && ! IsValidLayout( 64, arrayOutside, arrayEmpty );
+}
+
+bool TestEffectiveMutations()
+{
+	// Unchanged writes and a write that restores the previous step are ineffective.
+	std::array< byte, 4 > arrayBuffer {};
+	EffectiveGenerator< Xoshiro256StarStar > generator { Xoshiro256StarStar { std::random_device {}() } };
+	std::array< unsigned int, 4 > arrayIneffective {};
+	generator.BeginRound();
+	for( size_t i = 0; i < arrayIneffective.size(); i++ )
+	{
+		generator.BeginStep( 0 );
+		Details::NotifyWrite( generator, arrayBuffer, 1, 1 );
+		if( i > 0 )
+			arrayBuffer[ 1 ] ^= byte { 4 };
+		generator.EndStep();
+		arrayIneffective[ i ] = generator.IneffectiveSteps();
+	}
+	if( arrayIneffective != std::array< unsigned int, 4 > { 1, 0, 2, 0 } || generator.GetIneffectiveCount() != 3 )
+		return false;
+
+	// Rounds on a single byte skip ineffective steps without allocating.
+	HavocEngine< EffectiveGenerator< Xoshiro256StarStar > > engine;
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	size_t sizeValue = 1;
+	for( int i = 0; i < 10000; i++ )
+	{
+		sizeValue = engine( arrayBuffer, sizeValue, generator ).size();
+		sizeValue = Havoc< DefaultOps< EffectiveGenerator< Xoshiro256StarStar > > >( arrayBuffer, sizeValue, generator ).size();
+	}
+	return g_sizeAllocations == sizeAllocationsBefore && generator.GetIneffectiveCount() > 3;
+}
+
+bool TestDeterministicStages()
+{
+	// Every mutant changes a single run of at most four bytes and the seed is restored at the end.
+	const std::array< byte, 6 > arraySeed { byte { 0x00 }, byte { 0x7f }, byte { 0x80 }, byte { 0xff }, byte { 0x10 }, byte { 0x01 } };
+	std::array< byte, 6 > arrayValue = arraySeed;
+	std::vector< std::array< byte, 6 > > vecMutants;
+	DeterministicMutator<> mutator;
+	while( mutator.Next( arrayValue ) )
+	{
+		auto first = std::ranges::mismatch( arrayValue, arraySeed ).in1;
+		auto last = std::ranges::mismatch( arrayValue | std::views::reverse, arraySeed | std::views::reverse ).in1.base();
+		if( first == arrayValue.end() || last - first > 4 )
+			return false;
+		vecMutants.push_back( arrayValue );
+	}
+	if( arrayValue != arraySeed || mutator.GetCursor().stage != DeterministicStage::Done ||
+			vecMutants.size() > DeterministicMutator<>::CountMutants( arraySeed.size() ) )
+		return false;
+
+	// A mutator resumed from a cursor produces the remaining mutants.
+	DeterministicMutator<> first;
+	for( size_t i = 0; i < vecMutants.size() / 2; i++ )
+		first.Next( arrayValue );
+	first.Restore( arrayValue );
+	DeterministicMutator<> resumed { {}, first.GetCursor() };
+	for( size_t i = vecMutants.size() / 2; i < vecMutants.size(); i++ )
+	{
+		if( ! resumed.Next( arrayValue ) || arrayValue != vecMutants[ i ] )
+			return false;
+	}
+	if( resumed.Next( arrayValue ) )
+		return false;
+
+	// Ineffective bytes are skipped.
+	const std::array< uint64_t, 1 > arrayNone { 0 };
+	const std::array< uint64_t, 1 > arrayFirst { 1 };
+	DeterministicMutator<> none { arrayNone };
+	if( none.Next( arrayValue ) )
+		return false;
+	DeterministicMutator<> onlyFirst { arrayFirst };
+	size_t sizeMutants = 0;
+	while( onlyFirst.Next( arrayValue ) )
+		sizeMutants++;
+	return sizeMutants > 0 && sizeMutants < vecMutants.size() / 2;
+}
+
+//! Eager coroutine that consumes mutants of an asynchronous producer in tests.
+struct ConsumerTask
+{
+	struct promise_type
+	{
+		ConsumerTask get_return_object()
+		{
+			return {};
+		}
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+		void return_void()
+		{
+		}
+		void unhandled_exception()
+		{
+			std::terminate();
+		}
+	};
+};
+
+//! Awaits mutants one by one and checks that they have the expected sizes.
+ConsumerTask ConsumeMutants( AsyncHavoc<>& async, std::span< const size_t > spanExpected, bool& bMatched )
+{
+	for( size_t sizeExpected : spanExpected )
+	{
+		RingMutant mutant = co_await async.Next();
+		bMatched = bMatched && mutant.spanData.size() == sizeExpected;
+		async.Release();
+	}
+}
+
+bool TestAsyncHavoc()
+{
+	// Mutants are produced in the order of a synchronous engine using the same generator.
+	// Grown mutants may keep bytes of the previous contents of their slot, so only their sizes are compared.
+	std::array< byte, 16 > arraySeed {};
+	std::ranges::fill( arraySeed, byte { 0x41 } );
+	std::array< byte, 64 > arrayBuffer {};
+	Xoshiro256StarStar generator { std::random_device {}() };
+	AsyncHavoc<> async { arraySeed, arrayBuffer.size(), 4, generator };
+	HavocEngine< Xoshiro256StarStar > engine;
+	std::array< size_t, 12 > arrayExpected {};
+	for( size_t& sizeExpected : arrayExpected )
+	{
+		std::ranges::copy( arraySeed, arrayBuffer.begin() );
+		sizeExpected = engine( arrayBuffer, arraySeed.size(), generator ).size();
+	}
+
+	// Filling stops when every slot is taken and does not allocate.
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	if( async.Fill() != async.Slots() || async.Pump() )
+		return false;
+	for( size_t i = 0; i < 4; i++ )
+	{
+		if( async.Take().spanData.size() != arrayExpected[ i ] )
+			return false;
+		async.Release();
+	}
+	if( g_sizeAllocations != sizeAllocationsBefore )
+		return false;
+
+	// A coroutine awaiting an empty ring resumes the producer.
+	bool bMatched = true;
+	ConsumeMutants( async, std::span { arrayExpected }.subspan( 4 ), bMatched );
+	return bMatched && async.GetGenerator() == generator;
+}
+
+bool TestStackDepthPolicies()
+{
+	// Every round plans the number of mutations drawn by the policy.
+	std::array< byte, 64 > arrayBuffer {};
+	Xoshiro256StarStar random { std::random_device {}() };
+	HavocEngine< Xoshiro256StarStar, 5, UniformScheduler<>, CountingInstrumentation<>, FixedDepth< 3 > > engineFixed;
+	HavocEngine< Xoshiro256StarStar, 5, UniformScheduler<>, CountingInstrumentation<>, AdaptiveDepth< 7, 1 > > engineAdaptive;
+	size_t sizeValue = 16;
+	for( int i = 0; i < 100; i++ )
+	{
+		sizeValue = engineFixed( arrayBuffer, sizeValue, random ).size();
+		engineAdaptive( arrayBuffer, arrayBuffer.size(), random );
+		sizeValue = Havoc< AFLStackDepth<> >( std::span { arrayBuffer }, sizeValue, random ).size();
+		sizeValue = Havoc< DefaultOps< Xoshiro256StarStar >, FixedDepth< 2 > >( std::span { arrayBuffer }, sizeValue, random ).size();
+	}
+	return engineFixed.GetInstrumentation().GetSnapshot().ui64PlannedIterations == 300 &&
+			engineAdaptive.GetInstrumentation().GetSnapshot().ui64PlannedIterations == 100;
+}
+
+bool TestSegmentedHavoc()
+{
+	// Segmented rounds produce the same values as rounds on the flattened segments.
+	Xoshiro256StarStar random { std::random_device {}() };
+	const std::array< size_t, 5 > arraySizes { 40, 1, 17, 0, 70 };
+	const size_t sizeCapacity = 256;
+	std::vector< byte > vecStorage( std::accumulate( arraySizes.begin(), arraySizes.end(), size_t { 0 } ) );
+	std::vector< byte > vecBuffer( sizeCapacity );
+	PieceTable tableSegments { sizeCapacity * 16 };
+	PieceTable tableBuffer { sizeCapacity * 16 };
+	std::vector< byte > vecMutant;
+	vecMutant.reserve( sizeCapacity );
+	size_t sizeAllocationsBefore = g_sizeAllocations;
+	for( int i = 0; i < 1000; i++ )
+	{
+		// Split the storage into segments with a known pattern.
+		std::array< std::span< byte >, 5 > arraySegments {};
+		for( size_t j = 0, sizeOffset = 0; j < arraySizes.size(); sizeOffset += arraySizes[ j++ ] )
+			arraySegments[ j ] = std::span { vecStorage }.subspan( sizeOffset, arraySizes[ j ] );
+		for( size_t j = 0; j < vecStorage.size(); j++ )
+			vecStorage[ j ] = static_cast< byte >( j * 7 + i );
+		std::ranges::copy( vecStorage, vecBuffer.begin() );
+
+		// Mutate both representations with the same stream.
+		Xoshiro256StarStar randomBuffer = random;
+		std::span< const std::span< byte > > spanPieces = SegmentedHavoc( tableSegments, arraySegments, sizeCapacity, random );
+		std::span< byte > spanExpected = PieceTableHavoc( tableBuffer, vecBuffer, vecStorage.size(), randomBuffer );
+		vecMutant.clear();
+		for( std::span< byte > spanPiece : spanPieces )
+			vecMutant.insert( vecMutant.end(), spanPiece.begin(), spanPiece.end() );
+		if( ! std::ranges::equal( vecMutant, spanExpected ) || random != randomBuffer )
+			return false;
+	}
+	return g_sizeAllocations == sizeAllocationsBefore;
+}
+
+//! Tests that a scratch clone gives the same bytes as memmove for every size and overlap around its threshold.
+template< class Clone >
+bool TestScratchCloneOverlaps(
+	size_t sizeThreshold  //!< Largest block cloned through the scratch.
+)
+{
+	// Destinations before the source clone forward and destinations after it clone backward.
+	std::vector< byte > vecExpected( 8 * sizeThreshold + 64 );
+	std::vector< byte > vecActual( vecExpected.size() );
+	std::array< bool, 4 > arrayCovered {};
+	for( size_t sizeBlock = 0; sizeBlock <= 2 * sizeThreshold + 8; sizeBlock++ )
+	{
+		bool bScratch = Clone::IsScratchCopy( sizeBlock );
+		for( size_t sizeDestination = 0; sizeDestination <= 2 * sizeBlock; sizeDestination++ )
+		{
+			for( size_t i = 0; i < vecExpected.size(); i++ )
+				vecExpected[ i ] = vecActual[ i ] = static_cast< byte >( i * 13 );
+			std::memmove( vecExpected.data() + sizeDestination, vecExpected.data() + sizeBlock, sizeBlock );
+			Clone::Move( vecActual.data() + sizeDestination, vecActual.data() + sizeBlock, sizeBlock );
+			if( vecActual != vecExpected )
+				return false;
+			if( sizeDestination != sizeBlock )
+				arrayCovered[ ( bScratch ? 2 : 0 ) + ( sizeDestination > sizeBlock ? 1 : 0 ) ] = true;
+		}
+	}
+
+	// Blocks up to the threshold must go through the scratch and larger ones must not.
+	return std::ranges::all_of( arrayCovered, []( bool b ) { return b; } ) && Clone::IsScratchCopy( sizeThreshold ) &&
+			! Clone::IsScratchCopy( sizeThreshold + 1 );
+}
+
+bool TestScratchCloneMatchesMove()
+{
+	// Every size and overlap must give the same bytes as memmove with the default and with other thresholds.
+	if( ! TestScratchCloneOverlaps< ScratchClone<> >( 64 ) || ! TestScratchCloneOverlaps< ScratchClone< 24 > >( 24 ) ||
+			! TestScratchCloneOverlaps< ScratchClone< 100 > >( 100 ) )
+		return false;
+
+	// Mutations take the policy as a template argument.
+	Xoshiro256StarStar random { std::random_device {}() };
+	std::array< byte, 32 > arrayBuffer {};
+	for( int i = 0; i < 1000; i++ )
+	{
+		RandomChunkOverwrite< Xoshiro256StarStar, ScratchClone<> >( arrayBuffer, random );
+		RandomBlockInsert< Xoshiro256StarStar, ScratchClone<> >( arrayBuffer, arrayBuffer.size() / 2, random );
+	}
+	return std::ranges::any_of( arrayBuffer, []( byte b ) { return b != byte { 0 }; } );
+}
+
+bool TestSharedTestcase()
+{
+	// Mutants are written after the length header and the header holds their size.
+	alignas( 4 ) std::array< byte, SharedTestcase::HeaderSize + 64 > arrayRegion {};
+	SharedTestcase testcase { arrayRegion };
+	const std::array< byte, 8 > arraySeed { byte { 1 }, byte { 2 }, byte { 3 }, byte { 4 } };
+	if( testcase.Capacity() != 64 || testcase.Assign( arraySeed ).size() != arraySeed.size() || testcase.GetSize() != arraySeed.size() )
+		return false;
+
+	Xoshiro256StarStar random { std::random_device {}() };
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( int i = 0; i < 1000; i++ )
+	{
+		std::span< byte > spanMutant = i % 2 == 0 ? testcase.Havoc( engine, random ) : testcase.Havoc( engine, arraySeed, random );
+		uint32_t ui32Length = 0;
+		std::memcpy( &ui32Length, arrayRegion.data(), sizeof( ui32Length ) );
+		if( spanMutant.data() != arrayRegion.data() + SharedTestcase::HeaderSize || ui32Length != spanMutant.size() ||
+				spanMutant.size() > testcase.Capacity() || testcase.GetValue().size() != spanMutant.size() )
+			return false;
+	}
+	return true;
+}
+
+bool TestHotRegions()
+{
+	// Offsets are only drawn from blocks with weight and fall back to uniform offsets without any.
+	HotRegionMap map { 1000, 6, 0 };
+	map.SetWeight( 3, 5 );
+	Xoshiro256StarStar random { std::random_device {}() };
+	if( map.Blocks() != 16 || map.Prefix( map.Blocks() ) != 5 )
+		return false;
+	for( int i = 0; i < 1000; i++ )
+	{
+		size_t sizeHot = map.Draw( 1023, random );
+		size_t sizeCold = map.Draw( 100, random );
+		if( sizeHot < 192 || sizeHot >= 256 || sizeCold > 100 )
+			return false;
+	}
+
+	// Mutations of the adaptor touch only the hot block.
+	std::vector< byte > vecValue( 1000 );
+	HotRegionGenerator< Xoshiro256StarStar > hot { random, map };
+	for( int i = 0; i < 1000; i++ )
+	{
+		FlipBit( std::span { vecValue }, hot );
+		ArithmeticSmallDelta( std::span { vecValue }.first( 250 ), hot );
+	}
+	for( size_t i = 0; i < vecValue.size(); i++ )
+	{
+		if( vecValue[ i ] != byte { 0 } && ( i < 192 || i >= 256 ) )
+			return false;
+	}
+
+	// Rewards credit the blocks written by the latest round.
+	map.Fill( 1 );
+	HavocEngine< HotRegionGenerator< Xoshiro256StarStar > > engine;
+	std::vector< byte > vecBuffer( 2000 );
+	engine( vecBuffer, 1000, hot );
+	hot.Reward( 10 );
+	uint64_t ui64Expected = map.Blocks();
+	for( size_t i = 0; i < map.Blocks(); i++ )
+		ui64Expected += map.GetWeight( i ) - 1;
+	return ! hot.GetRanges().Get().empty() && map.Prefix( map.Blocks() ) == ui64Expected && ui64Expected > map.Blocks();
+}
+
+bool TestStreamingHavoc()
+{
+	// The segments are the value with the mutated windows in place of the original bytes.
+	std::vector< byte > vecValue( 10000 );
+	for( size_t i = 0; i < vecValue.size(); i++ )
+		vecValue[ i ] = static_cast< byte >( i * 7 );
+	StreamingHavoc streaming { 256, 64, 4 };
+	Xoshiro256StarStar random { std::random_device {}() };
+	HavocEngine< Xoshiro256StarStar > engine;
+	for( int i = 0; i < 1000; i++ )
+	{
+		std::span< const std::span< const byte > > spanSegments = streaming.Mutate( engine, vecValue, random );
+		std::vector< byte > vecExpected;
+		size_t sizeCopied = 0;
+		for( const StreamWindow& window : streaming.GetWindows() )
+		{
+			if( window.sizeOffset < sizeCopied || window.sizeOriginal > 256 || window.spanMutant.size() > window.sizeOriginal + 64 )
+				return false;
+			vecExpected.insert( vecExpected.end(), vecValue.begin() + sizeCopied, vecValue.begin() + window.sizeOffset );
+			vecExpected.insert( vecExpected.end(), window.spanMutant.begin(), window.spanMutant.end() );
+			sizeCopied = window.sizeOffset + window.sizeOriginal;
+		}
+		vecExpected.insert( vecExpected.end(), vecValue.begin() + sizeCopied, vecValue.end() );
+		std::vector< byte > vecJoined;
+		for( std::span< const byte > spanSegment : spanSegments )
+			vecJoined.insert( vecJoined.end(), spanSegment.begin(), spanSegment.end() );
+		if( streaming.GetWindows().empty() || streaming.GetWindows().size() > 4 || vecJoined != vecExpected || vecJoined.size() != streaming.Size() )
+			return false;
+	}
+
+	// Empty values get a single window that grows.
+	if( streaming.Mutate( engine, std::span< const byte > {}, random ).size() != 1 || streaming.Size() == 0 )
+		return false;
+
+#if ! defined( _WIN32 )
+	// Gather writes produce the joined segments.
+	std::span< const std::span< const byte > > spanSegments = streaming.Mutate( engine, vecValue, random );
+	std::FILE* pFile = std::tmpfile();
+	if( pFile == nullptr || ! WriteSegments( fileno( pFile ), spanSegments ) )
+		return false;
+	std::vector< byte > vecWritten( streaming.Size() + 1 );
+	std::rewind( pFile );
+	size_t sizeRead = std::fread( vecWritten.data(), 1, vecWritten.size(), pFile );
+	std::fclose( pFile );
+	size_t sizeOffset = 0;
+	for( std::span< const byte > spanSegment : spanSegments )
+	{
+		if( ! std::ranges::equal( spanSegment, std::span { vecWritten }.subspan( sizeOffset, spanSegment.size() ) ) )
+			return false;
+		sizeOffset += spanSegment.size();
+	}
+	return sizeRead == streaming.Size();
+#else
+	return true;
+#endif
+}
+
 int main()
 {
 	if( ! TestFunctionsDoMutate() )
@@ -65,6 +1209,158 @@ int main()
 		return 1;
 	}
 
+	if( ! TestHavocEngineDoesNotAllocate() )
+	{
+		std::cerr << "TestHavocEngineDoesNotAllocate failed" << std::endl;
+		return 1;
+	}
+
+	if( ! TestAliasTableMatchesWeights() )
+	{
+		std::cerr << "TestAliasTableMatchesWeights failed" << std::endl;
+		return 1;
+	}
+	if( ! TestWeightedSchedulerAdapts() )
+	{
+		std::cerr << "TestWeightedSchedulerAdapts failed" << std::endl;
+		return 1;
+	}
+
+	if( ! TestHavocBatch() )
+	{
+		std::cerr << "TestHavocBatch failed" << std::endl;
+		return 1;
+	}
+
+	if( ! TestFastRandom() )
+	{
+		std::cerr << "TestFastRandom failed" << std::endl;
+		return 1;
+	}
+
+	if( ! TestStaticHavoc() )
+	{
+		std::cerr << "TestStaticHavoc failed" << std::endl;
+		return 1;
+	}
+
+	if( ! TestBlockOperationsKeepData() )
+	{
+		std::cerr << "TestBlockOperationsKeepData failed" << std::endl;
+		return 1;
+	}
+
+	if( ! TestPieceTableMatchesVector() )
+	{
+		std::cerr << "TestPieceTableMatchesVector failed" << std::endl;
+		return 1;
+	}
+	if( ! TestPieceTableHavoc() )
+	{
+		std::cerr << "TestPieceTableHavoc failed" << std::endl;
+		return 1;
+	}
+	if( ! TestInstrumentationCountsMutations() )
+	{
+		std::cerr << "TestInstrumentationCountsMutations failed" << std::endl;
+		return 1;
+	}
+	if( ! TestWorkStealingDequeTakesEveryItemOnce() )
+	{
+		std::cerr << "TestWorkStealingDequeTakesEveryItemOnce failed" << std::endl;
+		return 1;
+	}
+	if( ! TestParallelHavoc() )
+	{
+		std::cerr << "TestParallelHavoc failed" << std::endl;
+		return 1;
+	}
+	if( ! TestTraceReplaysHavoc() )
+	{
+		std::cerr << "TestTraceReplaysHavoc failed" << std::endl;
+		return 1;
+	}
+	if( ! TestDirtyRangesCoverChanges() )
+	{
+		std::cerr << "TestDirtyRangesCoverChanges failed" << std::endl;
+		return 1;
+	}
+	if( ! TestUndoJournalReverts() )
+	{
+		std::cerr << "TestUndoJournalReverts failed" << std::endl;
+		return 1;
+	}
+	if( ! TestDictionaryMutations() )
+	{
+		std::cerr << "TestDictionaryMutations failed" << std::endl;
+		return 1;
+	}
+	if( ! TestSpliceWithMappedCorpus() )
+	{
+		std::cerr << "TestSpliceWithMappedCorpus failed" << std::endl;
+		return 1;
+	}
+	if( ! TestIntegerWidths() )
+	{
+		std::cerr << "TestIntegerWidths failed" << std::endl;
+		return 1;
+	}
+	if( ! TestInterestingTable() )
+	{
+		std::cerr << "TestInterestingTable failed" << std::endl;
+		return 1;
+	}
+	if( ! TestHavocFields() )
+	{
+		std::cerr << "TestHavocFields failed" << std::endl;
+		return 1;
+	}
+	if( ! TestEffectiveMutations() )
+	{
+		std::cerr << "TestEffectiveMutations failed" << std::endl;
+		return 1;
+	}
+	if( ! TestDeterministicStages() )
+	{
+		std::cerr << "TestDeterministicStages failed" << std::endl;
+		return 1;
+	}
+	if( ! TestAsyncHavoc() )
+	{
+		std::cerr << "TestAsyncHavoc failed" << std::endl;
+		return 1;
+	}
+	if( ! TestStackDepthPolicies() )
+	{
+		std::cerr << "TestStackDepthPolicies failed" << std::endl;
+		return 1;
+	}
+	if( ! TestSegmentedHavoc() )
+	{
+		std::cerr << "TestSegmentedHavoc failed" << std::endl;
+		return 1;
+	}
+	if( ! TestScratchCloneMatchesMove() )
+	{
+		std::cerr << "TestScratchCloneMatchesMove failed" << std::endl;
+		return 1;
+	}
+	if( ! TestSharedTestcase() )
+	{
+		std::cerr << "TestSharedTestcase failed" << std::endl;
+		return 1;
+	}
+	if( ! TestHotRegions() )
+	{
+		std::cerr << "TestHotRegions failed" << std::endl;
+		return 1;
+	}
+	if( ! TestStreamingHavoc() )
+	{
+		std::cerr << "TestStreamingHavoc failed" << std::endl;
+		return 1;
+	}
+
 	std::cout << "All tests passed" << std::endl;
 	return 0;
 }
\ No newline at end of file
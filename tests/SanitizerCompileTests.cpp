@@ -0,0 +1,25 @@
+#include "AFLMutationFunctions.hh"
+#include "AFLMutationFunctions/PieceTable.hh"
+#include <array>
+#include <cstddef>
+#include <random>
+#include <span>
+
+using namespace AFLMutationFunctions;
+
+// The piece table operations are matched to the mutations at compile-time. Compilers restrict constant
+// expressions when null pointer checks are instrumented, so this file is compiled with the undefined behavior sanitizer.
+template< class Gen >
+void InstantiatePieceTableHavoc()
+{
+	Gen random {};
+	PieceTable table { 64 };
+	std::array< std::byte, 32 > arrayBuffer {};
+	PieceTableHavoc( table, arrayBuffer, 8, random );
+	std::array< std::span< std::byte >, 1 > arraySegments { std::span { arrayBuffer } };
+	SegmentedHavoc( table, arraySegments, 64, random );
+}
+
+template void InstantiatePieceTableHavoc< Xoshiro256StarStar >();
+template void InstantiatePieceTableHavoc< RandomBitPool< Xoshiro256StarStar > >();
+template void InstantiatePieceTableHavoc< std::minstd_rand >();
\ No newline at end of file